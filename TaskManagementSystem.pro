@@ -3,6 +3,9 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# 在线备份直接使用 SQLite 的备份接口
+LIBS += -lsqlite3
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -17,14 +20,19 @@ HEADERS += \
 #数据库模块
 SOURCES += \
     database/database.cpp\
+    database/backupengine.cpp\
+    database/queryprofiler.cpp\
 
 HEADERS += \
     database/database.h\
+    database/backupengine.h\
+    database/queryprofiler.h\
 
 #模型模块
 SOURCES += \
     models/taskmodel.cpp \
     models/inspirationmodel.cpp \
+    models/inspirationfiltermodel.cpp \
     models/taskfiltermodel.cpp \
     models/taskitem.cpp \
     models/statisticmodel.cpp
@@ -32,6 +40,7 @@ SOURCES += \
 HEADERS += \
     models/taskmodel.h \
     models/inspirationmodel.h \
+    models/inspirationfiltermodel.h \
     models/taskfiltermodel.h \
     models/taskitem.h\
     models/statisticmodel.h
@@ -72,10 +81,26 @@ HEADERS += \
 
 #线程模块
 SOURCES += \
-    threads/remindthread.cpp
+    threads/archivethread.cpp \
+    threads/backupthread.cpp \
+    threads/exportthread.cpp \
+    threads/importthread.cpp \
+    threads/periodicworker.cpp \
+    threads/purgethread.cpp \
+    threads/remindthread.cpp \
+    threads/restorethread.cpp \
+    threads/statisticthread.cpp
 
 HEADERS += \
-    threads/remindthread.h
+    threads/archivethread.h \
+    threads/backupthread.h \
+    threads/exportthread.h \
+    threads/importthread.h \
+    threads/periodicworker.h \
+    threads/purgethread.h \
+    threads/remindthread.h \
+    threads/restorethread.h \
+    threads/statisticthread.h
 
 #控件模块
 SOURCES += \
@@ -85,6 +110,8 @@ SOURCES += \
     widgets/statuswidget.cpp \
     widgets/comboboxdelegate.cpp\
     widgets/simplechartwidget.cpp \
+    widgets/textlayoutcache.cpp \
+    widgets/heatmapwidget.cpp \
 
 HEADERS += \
     widgets/watermarkwidget.h \
@@ -93,13 +120,25 @@ HEADERS += \
     widgets/statuswidget.h \
     widgets/comboboxdelegate.h\
     widgets/simplechartwidget.h \
+    widgets/textlayoutcache.h \
+    widgets/heatmapwidget.h \
 
 #工具模块
 SOURCES += \
     utils/exporter.cpp \
+    utils/themepalette.cpp \
+    utils/stylesheetengine.cpp \
+    utils/durationsketch.cpp \
+    utils/zipwriter.cpp \
+    utils/importer.cpp \
 
 HEADERS += \
    utils/exporter.h \
+   utils/themepalette.h \
+   utils/stylesheetengine.h \
+   utils/durationsketch.h \
+   utils/zipwriter.h \
+   utils/importer.h \
 
 # 包含路径
 INCLUDEPATH += \
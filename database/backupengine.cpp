@@ -0,0 +1,361 @@
+#include "backupengine.h"
+#include "database.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QThread>
+#include <QDebug>
+#include <sqlite3.h>
+
+namespace {
+
+// 每批复制的页数和批间隔：批间释放源库的读锁，界面线程的写入最多等待一批
+const int kPagesPerStep = 256;
+const int kStepPauseMs = 5;
+const int kBusyPauseMs = 100;
+
+const QRegularExpression kBackupNamePattern("^task_(\\d{8}_\\d{6})_(full|diff_\\d{8}_\\d{6})\\.db$");
+
+QString tempConnectionName(const QString &purpose)
+{
+    return QString("backup_%1_%2").arg(purpose).arg((quintptr)QThread::currentThreadId());
+}
+
+bool execOrLog(QSqlQuery &query, const QString &sql)
+{
+    if (query.exec(sql)) return true;
+    qDebug() << "备份语句执行失败:" << sql << query.lastError().text();
+    return false;
+}
+
+bool attachDiff(QSqlDatabase &db, const QString &path)
+{
+    QSqlQuery query(db);
+    query.prepare("ATTACH DATABASE ? AS diff");
+    query.addBindValue(path);
+    if (query.exec()) return true;
+    qDebug() << "附加差异备份失败:" << query.lastError().text();
+    return false;
+}
+
+void detachDiff(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    query.exec("DETACH DATABASE diff");
+}
+
+} // namespace
+
+bool BackupEngine::onlineBackup(const QString &srcPath, const QString &destPath, const Progress &progress)
+{
+    // 先写到临时文件，完成后再替换目标，中途失败不会留下半个备份
+    QString partPath = destPath + ".part";
+    QFile::remove(partPath);
+
+    sqlite3 *src = nullptr;
+    sqlite3 *dest = nullptr;
+    bool ok = false;
+    bool canceled = false;
+
+    if (sqlite3_open_v2(srcPath.toUtf8().constData(), &src, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        qDebug() << "备份时打开源数据库失败:" << sqlite3_errmsg(src);
+    } else if (sqlite3_open_v2(partPath.toUtf8().constData(), &dest,
+                               SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        qDebug() << "备份时创建目标文件失败:" << sqlite3_errmsg(dest);
+    } else {
+        sqlite3_backup *backup = sqlite3_backup_init(dest, "main", src, "main");
+        if (!backup) {
+            qDebug() << "初始化在线备份失败:" << sqlite3_errmsg(dest);
+        } else {
+            int rc;
+            while (true) {
+                rc = sqlite3_backup_step(backup, kPagesPerStep);
+                int total = sqlite3_backup_pagecount(backup);
+                int done = total - sqlite3_backup_remaining(backup);
+                if (progress && !progress(done, total)) {
+                    canceled = true;
+                    break;
+                }
+                if (rc == SQLITE_DONE) break;
+                if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) break;
+                // 源库被写入方锁住时多等一会儿再继续
+                sqlite3_sleep(rc == SQLITE_OK ? kStepPauseMs : kBusyPauseMs);
+            }
+            int finishRc = sqlite3_backup_finish(backup);
+            ok = !canceled && rc == SQLITE_DONE && finishRc == SQLITE_OK;
+            if (!ok && !canceled) {
+                qDebug() << "在线备份失败:" << sqlite3_errmsg(dest);
+            }
+        }
+    }
+
+    sqlite3_close(src);
+    sqlite3_close(dest);
+
+    if (!ok) {
+        QFile::remove(partPath);
+        return false;
+    }
+
+    if (QFile::exists(destPath)) {
+        QFile::remove(destPath);
+    }
+    return QFile::rename(partPath, destPath);
+}
+
+bool BackupEngine::writeDifferential(const QString &connectionName, const QString &destPath,
+                                     const QString &basePath, qint64 baseSeq)
+{
+    QString partPath = destPath + ".part";
+    QFile::remove(partPath);
+
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    if (!attachDiff(db, partPath)) return false;
+
+    // 在同一个读事务里取变化序号和变化行，保证两者一致
+    bool ok = db.transaction();
+    {
+        QSqlQuery query(db);
+        qint64 seq = 0;
+        int userVersion = 0;
+        QString chain;
+        ok = ok && execOrLog(query, "SELECT IFNULL(MAX(seq), 0) FROM main.change_log") && query.next();
+        if (ok) seq = query.value(0).toLongLong();
+        ok = ok && execOrLog(query, "PRAGMA main.user_version") && query.next();
+        if (ok) userVersion = query.value(0).toInt();
+        ok = ok && execOrLog(query, "SELECT IFNULL((SELECT value FROM main.user_settings WHERE key = 'backup_chain_id'), '')")
+             && query.next();
+        if (ok) chain = query.value(0).toString();
+
+        ok = ok && execOrLog(query, "CREATE TABLE diff.backup_meta (key TEXT PRIMARY KEY, value TEXT)");
+        const QList<QPair<QString, QVariant>> meta = {
+            {"kind", "diff"},
+            {"base", QFileInfo(basePath).fileName()},
+            {"base_seq", baseSeq},
+            {"seq", seq},
+            {"user_version", userVersion},
+            {"chain", chain},
+            {"created_at", QDateTime::currentDateTime()},
+        };
+        for (const auto &item : meta) {
+            if (!ok) break;
+            query.prepare("INSERT INTO diff.backup_meta (key, value) VALUES (?, ?)");
+            query.addBindValue(item.first);
+            query.addBindValue(item.second);
+            ok = query.exec();
+        }
+
+        ok = ok && execOrLog(query, "CREATE TABLE diff.change_set ("
+                                    "table_name TEXT NOT NULL, row_id INTEGER NOT NULL, "
+                                    "PRIMARY KEY (table_name, row_id))");
+        if (ok) {
+            query.prepare("INSERT OR IGNORE INTO diff.change_set (table_name, row_id) "
+                          "SELECT table_name, row_id FROM main.change_log WHERE seq > ? AND seq <= ?");
+            query.addBindValue(baseSeq);
+            query.addBindValue(seq);
+            ok = query.exec();
+        }
+
+        // 变化过的行保存当前内容；已删除的行只出现在 change_set 中
+        for (const auto &table : Database::changeLogTables()) {
+            if (!ok) break;
+            ok = execOrLog(query, QString("CREATE TABLE diff.%1 AS SELECT * FROM main.%1 WHERE %2 IN "
+                                          "(SELECT row_id FROM diff.change_set WHERE table_name = '%1')")
+                                      .arg(table.first, table.second));
+        }
+    }
+
+    if (ok) {
+        ok = db.commit();
+    } else {
+        db.rollback();
+    }
+    detachDiff(db);
+
+    if (!ok) {
+        QFile::remove(partPath);
+        return false;
+    }
+
+    if (QFile::exists(destPath)) {
+        QFile::remove(destPath);
+    }
+    return QFile::rename(partPath, destPath);
+}
+
+bool BackupEngine::applyDifferential(const QString &targetPath, const QString &diffPath)
+{
+    QString connectionName = tempConnectionName("apply");
+    bool ok = false;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(targetPath);
+
+        if (!db.open()) {
+            qDebug() << "还原差异备份时打开目标数据库失败:" << db.lastError().text();
+        } else if (attachDiff(db, diffPath)) {
+            {
+                QSqlQuery query(db);
+                ok = execOrLog(query, "PRAGMA main.user_version") && query.next();
+                int targetVersion = ok ? query.value(0).toInt() : -1;
+                ok = ok && execOrLog(query, "SELECT value FROM diff.backup_meta WHERE key = 'user_version'") && query.next();
+                if (ok && query.value(0).toInt() != targetVersion) {
+                    qDebug() << "差异备份与基准备份的数据库版本不一致";
+                    ok = false;
+                }
+
+                ok = ok && db.transaction();
+                // 先删掉所有变化过的行，再写回仍然存在的行；触发器会同步维护统计汇总表
+                for (const auto &table : Database::changeLogTables()) {
+                    if (!ok) break;
+                    ok = execOrLog(query, QString("DELETE FROM main.%1 WHERE %2 IN "
+                                                  "(SELECT row_id FROM diff.change_set WHERE table_name = '%1')")
+                                              .arg(table.first, table.second))
+                         && execOrLog(query, QString("INSERT OR REPLACE INTO main.%1 SELECT * FROM diff.%1")
+                                                 .arg(table.first));
+                }
+                if (ok) {
+                    ok = db.commit();
+                } else {
+                    db.rollback();
+                }
+            }
+            detachDiff(db);
+        }
+        db.close();
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+QVariantMap BackupEngine::readMeta(const QString &backupPath)
+{
+    QVariantMap meta;
+    if (!QFile::exists(backupPath)) return meta;
+
+    QString connectionName = tempConnectionName("meta");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(backupPath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec("SELECT key, value FROM backup_meta")) {
+                while (query.next()) {
+                    meta.insert(query.value(0).toString(), query.value(1));
+                }
+            } else {
+                // 没有 backup_meta 表的是完整备份（包括手动备份的任意文件）
+                meta.insert("kind", "full");
+                if (query.exec("SELECT IFNULL(MAX(seq), 0) FROM change_log") && query.next()) {
+                    meta.insert("seq", query.value(0));
+                }
+                if (query.exec("PRAGMA user_version") && query.next()) {
+                    meta.insert("user_version", query.value(0));
+                }
+                if (query.exec("SELECT value FROM user_settings WHERE key = 'backup_chain_id'") && query.next()) {
+                    meta.insert("chain", query.value(0));
+                }
+            }
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return meta;
+}
+
+bool BackupEngine::materialize(const QString &backupPath, const QString &outPath, const Progress &progress)
+{
+    QVariantMap meta = readMeta(backupPath);
+    if (meta.value("kind").toString() != "diff") {
+        return onlineBackup(backupPath, outPath, progress);
+    }
+
+    QString basePath = QFileInfo(backupPath).dir().filePath(meta.value("base").toString());
+    if (!QFile::exists(basePath)) {
+        qDebug() << "找不到差异备份对应的基准备份:" << basePath;
+        return false;
+    }
+
+    if (!onlineBackup(basePath, outPath, progress) || !applyDifferential(outPath, backupPath)) {
+        QFile::remove(outPath);
+        return false;
+    }
+    return true;
+}
+
+BackupEngine::LatestSet BackupEngine::latestSet(const QString &dir)
+{
+    LatestSet set;
+    QDir backupDir(dir);
+
+    QStringList fulls = backupDir.entryList({"task_*_full.db"}, QDir::Files, QDir::Name | QDir::Reversed);
+    for (const QString &name : fulls) {
+        if (baseStamp(name).isEmpty()) continue;
+        set.basePath = backupDir.filePath(name);
+        QVariantMap baseMeta = readMeta(set.basePath);
+        set.baseSeq = baseMeta.value("seq").toLongLong();
+        set.chain = baseMeta.value("chain").toString();
+        set.lastPath = set.basePath;
+        set.lastSeq = set.baseSeq;
+
+        // 文件名中的时间戳定长，按名称倒序即按时间倒序
+        QStringList diffs = backupDir.entryList({QString("task_%1_diff_*.db").arg(baseStamp(name))},
+                                                QDir::Files, QDir::Name | QDir::Reversed);
+        for (const QString &diffName : diffs) {
+            QVariantMap meta = readMeta(backupDir.filePath(diffName));
+            if (meta.value("kind").toString() != "diff") continue;
+            set.lastPath = backupDir.filePath(diffName);
+            set.lastSeq = meta.value("seq").toLongLong();
+            break;
+        }
+        break;
+    }
+    return set;
+}
+
+void BackupEngine::rotate(const QString &dir, int keepSets)
+{
+    QDir backupDir(dir);
+    QStringList names = backupDir.entryList({"task_*.db"}, QDir::Files, QDir::Name | QDir::Reversed);
+
+    QStringList keptStamps;
+    for (const QString &name : names) {
+        QString stamp = baseStamp(name);
+        if (stamp.isEmpty()) continue;
+        if (!keptStamps.contains(stamp)) {
+            if (keptStamps.size() < keepSets) {
+                keptStamps << stamp;
+            }
+        }
+        if (keptStamps.contains(stamp)) continue;
+
+        if (backupDir.remove(name)) {
+            qDebug() << "删除过期备份:" << name;
+        }
+    }
+}
+
+QString BackupEngine::fullBackupName(const QString &stamp)
+{
+    return QString("task_%1_full.db").arg(stamp);
+}
+
+QString BackupEngine::diffBackupName(const QString &baseStamp, const QString &stamp)
+{
+    return QString("task_%1_diff_%2.db").arg(baseStamp, stamp);
+}
+
+QString BackupEngine::baseStamp(const QString &fileName)
+{
+    QRegularExpressionMatch match = kBackupNamePattern.match(fileName);
+    return match.hasMatch() ? match.captured(1) : QString();
+}
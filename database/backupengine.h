@@ -0,0 +1,48 @@
+#ifndef BACKUPENGINE_H
+#define BACKUPENGINE_H
+
+#include <QString>
+#include <QVariantMap>
+#include <functional>
+
+// 备份引擎
+// 完整备份：用 SQLite 在线备份接口分批复制页面，每批之间释放读锁，不阻塞界面线程的写入
+// 差异备份：只保存自基准完整备份以来 change_log 记录过的行，还原时叠加到基准备份上
+// 定时备份放在备份目录中，文件名为 task_<基准时间>_full.db 与 task_<基准时间>_diff_<时间>.db，
+// 同一基准时间的完整备份和差异备份为一组，轮换时按组删除
+class BackupEngine
+{
+public:
+    // progress 参数为已复制页数和总页数，返回 false 时中止
+    using Progress = std::function<bool(int, int)>;
+
+    static bool onlineBackup(const QString &srcPath, const QString &destPath, const Progress &progress = nullptr);
+
+    // 在 connectionName 对应的连接上导出 baseSeq 之后的变化行；basePath 为同目录下的基准完整备份
+    static bool writeDifferential(const QString &connectionName, const QString &destPath,
+                                  const QString &basePath, qint64 baseSeq);
+    static bool applyDifferential(const QString &targetPath, const QString &diffPath);
+
+    // 读取备份信息：kind 为 full 或 diff，seq 为备份包含的最后一个变化序号，chain 为备份组标识，
+    // diff 另有 base 和 base_seq
+    static QVariantMap readMeta(const QString &backupPath);
+    // 把完整备份或差异备份还原成一个完整的数据库文件
+    static bool materialize(const QString &backupPath, const QString &outPath, const Progress &progress = nullptr);
+
+    struct LatestSet {
+        QString basePath;
+        qint64 baseSeq = 0;
+        QString chain;        // 基准完整备份的备份组标识，与当前数据库不同时不能再做差异备份
+        QString lastPath;     // 组内最新的备份（完整或差异）
+        qint64 lastSeq = 0;
+    };
+    static LatestSet latestSet(const QString &dir);
+    // 只保留最新的 keepSets 组备份
+    static void rotate(const QString &dir, int keepSets);
+
+    static QString fullBackupName(const QString &stamp);
+    static QString diffBackupName(const QString &baseStamp, const QString &stamp);
+    static QString baseStamp(const QString &fileName);
+};
+
+#endif // BACKUPENGINE_H
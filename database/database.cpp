@@ -3,8 +3,20 @@
 #include <QVariant>
 #include <QSqlRecord>
 #include <QCoreApplication>
-
-Database::Database(QObject *parent) : QObject(parent)
+#include "utils/durationsketch.h"
+#include "backupengine.h"
+#include "queryprofiler.h"
+#include <filesystem>
+#include <QTimer>
+#include <QFileInfo>
+#include <QUuid>
+#include <algorithm>
+
+static const int kDataVersionPollMs = 1000;
+
+Database::Database(QObject *parent)
+    : QObject(parent), archiveAttached(false), dataVersionCounter(0), changesPending(0), publishedSeq(0)
+    , dataVersionTimer(nullptr), lastDataVersion(0)
 {
     dbPath = QCoreApplication::applicationDirPath() + "/task_management.db";
 }
@@ -48,6 +60,7 @@ bool Database::initDatabase()
         QSqlDatabase::removeDatabase(connectionName);
     }
 
+    archiveAttached = false;
     db = QSqlDatabase::addDatabase("QSQLITE");
     db.setDatabaseName(dbPath);
 
@@ -59,10 +72,41 @@ bool Database::initDatabase()
     executeQuery("PRAGMA foreign_keys = ON");
 
     if (needCreate) {
+        // 必须在建表前设置，之后更改需要整库 VACUUM
+        executeQuery("PRAGMA auto_vacuum = INCREMENTAL");
         createTables();
         initDefaultData();
     }
 
+    // 先附加归档库，结构升级中重建汇总时才能包含归档任务；升级可能给 tasks 加列，之后再补齐一次
+    archiveAttached = attachArchive(db, archivePath());
+    upgradeSchema();
+    if (archiveAttached) archiveAttached = attachArchive(db, archivePath());
+    if (archiveAttached) reconcileArchive();
+
+    // 导出任务的外部编号以此区分来源数据库
+    if (getSetting("database_uuid").isEmpty()) {
+        setSetting("database_uuid", QUuid::createUuid().toString(QUuid::WithoutBraces));
+    }
+    if (getSetting("backup_chain_id").isEmpty()) {
+        startNewBackupChain(db);
+    }
+    publishedSeq.storeRelease(latestChangeSeq());
+
+    QueryProfiler &profiler = QueryProfiler::instance();
+    profiler.setLogPath(QFileInfo(dbPath).dir().filePath("logs/slow_queries.log"));
+    profiler.setSlowThresholdMs(getSetting("slow_query_threshold_ms", "100").toInt());
+    profiler.setEnabled(getSetting("query_profiler_enabled", "false") == "true");
+
+    lastDataVersion = readDataVersion();
+    if (!dataVersionTimer) {
+        dataVersionTimer = new QTimer(this);
+        dataVersionTimer->setInterval(kDataVersionPollMs);
+        connect(dataVersionTimer, &QTimer::timeout, this, &Database::checkExternalChanges);
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, dataVersionTimer, &QTimer::stop);
+    }
+    dataVersionTimer->start();
+
     qDebug() << "Database opened successfully";
     return true;
 }
@@ -135,6 +179,516 @@ void Database::createTables()
         );
 }
 
+void Database::upgradeSchema()
+{
+    QSqlQuery query(db);
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+
+    if (version < 1) {
+        qDebug() << "升级数据库结构: 创建每日统计汇总表";
+        beginTransaction();
+        executeQuery("CREATE INDEX IF NOT EXISTS idx_tasks_deadline ON tasks (deadline)");
+        executeQuery("CREATE INDEX IF NOT EXISTS idx_tasks_completed_at ON tasks (completed_at)");
+        createDailyRollup();
+        rebuildDailyRollup();
+        executeQuery("PRAGMA user_version = 1");
+        commitTransaction();
+    }
+
+    if (version < 2) {
+        qDebug() << "升级数据库结构: 创建耗时分布草图表";
+        beginTransaction();
+        createDurationSketch();
+        rebuildDailyRollup();
+        executeQuery("PRAGMA user_version = 2");
+        commitTransaction();
+    }
+
+    if (version < 3) {
+        qDebug() << "升级数据库结构: 添加任务外部编号";
+        beginTransaction();
+        // 导入时按外部编号去重，本地创建的任务该列为空
+        executeQuery("ALTER TABLE tasks ADD COLUMN external_id TEXT");
+        executeQuery("CREATE UNIQUE INDEX IF NOT EXISTS idx_tasks_external_id ON tasks (external_id) "
+                     "WHERE external_id IS NOT NULL");
+        executeQuery("PRAGMA user_version = 3");
+        commitTransaction();
+    }
+
+    if (version < 4) {
+        qDebug() << "升级数据库结构: 创建变更日志";
+        beginTransaction();
+        createChangeLog();
+        executeQuery("PRAGMA user_version = 4");
+        commitTransaction();
+    }
+
+    if (version < 5) {
+        // 已有数据库切换 auto_vacuum 需要一次整库 VACUUM，启动时执行会卡住界面，
+        // 由 PurgeThread 在空闲时于自己的连接上完成并写入版本 5；新建的数据库建表前已设置
+        int autoVacuum = 0;
+        if (query.exec("PRAGMA auto_vacuum") && query.next()) {
+            autoVacuum = query.value(0).toInt();
+        }
+        if (autoVacuum == 2) {
+            executeQuery("PRAGMA user_version = 5");
+        } else {
+            qDebug() << "数据库结构升级待完成: 增量回收空间将在空闲时启用";
+            executeQuery("PRAGMA auto_vacuum = INCREMENTAL");
+        }
+    }
+}
+
+const QList<QPair<QString, QString>> &Database::changeLogTables()
+{
+    static const QList<QPair<QString, QString>> tables = {
+        {"task_categories", "id"},
+        {"task_tags", "id"},
+        {"tasks", "id"},
+        {"task_tag_relations", "task_id"},
+        {"inspirations", "id"},
+        {"user_settings", "id"},
+    };
+    return tables;
+}
+
+// 变更日志：记录每次写入涉及的表和行键，差异备份据此只保存变化过的行
+void Database::createChangeLog()
+{
+    executeQuery(
+        "CREATE TABLE IF NOT EXISTS change_log ("
+        "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+        "table_name TEXT NOT NULL, "
+        "row_id INTEGER NOT NULL, "
+        "op TEXT NOT NULL, "
+        "changed_at DATETIME DEFAULT CURRENT_TIMESTAMP)"
+        );
+
+    static const QList<QPair<QString, QString>> events = {
+        {"insert", "NEW"}, {"update", "NEW"}, {"delete", "OLD"}
+    };
+    for (const auto &table : changeLogTables()) {
+        for (const auto &event : events) {
+            executeQuery(QString("CREATE TRIGGER IF NOT EXISTS trg_%1_log_%2 AFTER %3 ON %1 "
+                                 "BEGIN INSERT INTO change_log (table_name, row_id, op) "
+                                 "VALUES ('%1', %4.%5, '%6'); END")
+                             .arg(table.first, event.first, event.first.toUpper(),
+                                  event.second, table.second, event.first.left(1).toUpper()));
+        }
+    }
+}
+
+// 按天汇总的任务统计：已完成任务按完成日期归档，其余按截止日期归档
+// 由 tasks 表上的触发器增量维护
+void Database::createDailyRollup()
+{
+    executeQuery(
+        "CREATE TABLE IF NOT EXISTS task_daily_rollup ("
+        "day TEXT NOT NULL, "
+        "category_id INTEGER NOT NULL, "
+        "priority INTEGER NOT NULL, "
+        "status INTEGER NOT NULL, "
+        "task_count INTEGER NOT NULL DEFAULT 0, "
+        "duration_hours_sum REAL NOT NULL DEFAULT 0, "
+        "duration_count INTEGER NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (day, category_id, priority, status))"
+        );
+
+    auto dayExpr = [](const QString &row) {
+        return QString("CASE WHEN %1.status = 2 THEN date(%1.completed_at) ELSE date(%1.deadline) END").arg(row);
+    };
+    auto durationExpr = [](const QString &row) {
+        return QString("CASE WHEN %1.status = 2 THEN (julianday(%1.completed_at) - julianday(%1.created_at)) * 24 END").arg(row);
+    };
+
+    auto addRow = [&](const QString &row) {
+        return QString(
+                   "INSERT INTO task_daily_rollup "
+                   "(day, category_id, priority, status, task_count, duration_hours_sum, duration_count) "
+                   "SELECT d, IFNULL(%1.category_id, 0), IFNULL(%1.priority, 2), IFNULL(%1.status, 0), 1, "
+                   "IFNULL(h, 0), CASE WHEN h IS NULL THEN 0 ELSE 1 END "
+                   "FROM (SELECT %2 AS d, %3 AS h) WHERE %1.is_deleted = 0 AND d IS NOT NULL "
+                   "ON CONFLICT(day, category_id, priority, status) DO UPDATE SET "
+                   "task_count = task_count + 1, "
+                   "duration_hours_sum = duration_hours_sum + excluded.duration_hours_sum, "
+                   "duration_count = duration_count + excluded.duration_count; ")
+            .arg(row, dayExpr(row), durationExpr(row));
+    };
+
+    auto removeRow = [&](const QString &row) {
+        return QString(
+                   "UPDATE task_daily_rollup SET "
+                   "task_count = task_count - 1, "
+                   "duration_hours_sum = duration_hours_sum - IFNULL(%3, 0), "
+                   "duration_count = duration_count - (CASE WHEN (%3) IS NULL THEN 0 ELSE 1 END) "
+                   "WHERE %1.is_deleted = 0 AND day = %2 AND category_id = IFNULL(%1.category_id, 0) "
+                   "AND priority = IFNULL(%1.priority, 2) AND status = IFNULL(%1.status, 0); "
+                   "DELETE FROM task_daily_rollup WHERE day = %2 AND task_count <= 0; ")
+            .arg(row, dayExpr(row), durationExpr(row));
+    };
+
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_rollup_insert AFTER INSERT ON tasks "
+                 "BEGIN " + addRow("NEW") + "END");
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_rollup_delete AFTER DELETE ON tasks "
+                 "BEGIN " + removeRow("OLD") + "END");
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_rollup_update "
+                 "AFTER UPDATE OF status, completed_at, deadline, created_at, category_id, priority, is_deleted ON tasks "
+                 "BEGIN " + removeRow("OLD") + addRow("NEW") + "END");
+}
+
+// 已完成任务的耗时分布：按完成日期、分类、优先级存放对数分桶计数（见 DurationSketch）
+// metric 0 为交付周期（创建→完成），1 为执行耗时（开始→完成）
+static QString sketchBucketExpr(const QString &hours)
+{
+    return QString("IFNULL((SELECT bucket FROM duration_sketch_bounds WHERE upper_hours >= (%1) "
+                   "ORDER BY bucket LIMIT 1), %2)").arg(hours).arg(DurationSketch::BucketCount - 1);
+}
+
+static QString sketchLeadExpr(const QString &row)
+{
+    return QString("(julianday(%1.completed_at) - julianday(%1.created_at)) * 24").arg(row);
+}
+
+static QString sketchCompletionExpr(const QString &row)
+{
+    return QString("(julianday(%1.completed_at) - julianday(%1.start_time)) * 24").arg(row);
+}
+
+void Database::createDurationSketch()
+{
+    executeQuery(
+        "CREATE TABLE IF NOT EXISTS duration_sketch_bounds ("
+        "bucket INTEGER PRIMARY KEY, "
+        "upper_hours REAL NOT NULL)"
+        );
+
+    // 边界以 C++ 端为准写入，保证触发器和内存中的分桶完全一致
+    QSqlQuery query(db);
+    query.exec("DELETE FROM duration_sketch_bounds");
+    query.prepare("INSERT INTO duration_sketch_bounds (bucket, upper_hours) VALUES (?, ?)");
+    for (int i = 0; i < DurationSketch::BucketCount; ++i) {
+        query.addBindValue(i);
+        query.addBindValue(DurationSketch::bucketUpper(i));
+        query.exec();
+    }
+
+    executeQuery(
+        "CREATE TABLE IF NOT EXISTS task_duration_sketch ("
+        "day TEXT NOT NULL, "
+        "category_id INTEGER NOT NULL, "
+        "priority INTEGER NOT NULL, "
+        "metric INTEGER NOT NULL, "
+        "bucket INTEGER NOT NULL, "
+        "sample_count INTEGER NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (day, category_id, priority, metric, bucket))"
+        );
+
+    auto addRow = [](const QString &row) {
+        return QString(
+                   "INSERT INTO task_duration_sketch "
+                   "(day, category_id, priority, metric, bucket, sample_count) "
+                   "SELECT date(%1.completed_at), IFNULL(%1.category_id, 0), IFNULL(%1.priority, 2), m, %2, 1 "
+                   "FROM (SELECT 0 AS m, %3 AS h UNION ALL SELECT 1, %4) "
+                   "WHERE %1.is_deleted = 0 AND %1.status = 2 AND date(%1.completed_at) IS NOT NULL AND h IS NOT NULL "
+                   "ON CONFLICT(day, category_id, priority, metric, bucket) DO UPDATE SET "
+                   "sample_count = sample_count + 1; ")
+            .arg(row, sketchBucketExpr("h"), sketchLeadExpr(row), sketchCompletionExpr(row));
+    };
+
+    auto removeRow = [](const QString &row) {
+        return QString(
+                   "UPDATE task_duration_sketch SET sample_count = sample_count - 1 "
+                   "WHERE %1.is_deleted = 0 AND %1.status = 2 AND day = date(%1.completed_at) "
+                   "AND category_id = IFNULL(%1.category_id, 0) AND priority = IFNULL(%1.priority, 2) "
+                   "AND ((metric = 0 AND (%2) IS NOT NULL AND bucket = %3) "
+                   "OR (metric = 1 AND (%4) IS NOT NULL AND bucket = %5)); "
+                   "DELETE FROM task_duration_sketch WHERE day = date(%1.completed_at) AND sample_count <= 0; ")
+            .arg(row,
+                 sketchLeadExpr(row), sketchBucketExpr(sketchLeadExpr(row)),
+                 sketchCompletionExpr(row), sketchBucketExpr(sketchCompletionExpr(row)));
+    };
+
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_sketch_insert AFTER INSERT ON tasks "
+                 "BEGIN " + addRow("NEW") + "END");
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_sketch_delete AFTER DELETE ON tasks "
+                 "BEGIN " + removeRow("OLD") + "END");
+    executeQuery("CREATE TRIGGER IF NOT EXISTS trg_tasks_sketch_update "
+                 "AFTER UPDATE OF status, completed_at, created_at, start_time, category_id, priority, is_deleted ON tasks "
+                 "BEGIN " + removeRow("OLD") + addRow("NEW") + "END");
+}
+
+// 由 source 中满足 filter 的任务聚合出汇总行；accumulate 为 true 时累加到已有行上
+static QString rollupInsertSql(const QString &source, const QString &filter, bool accumulate)
+{
+    QString sql =
+        "INSERT INTO task_daily_rollup "
+        "(day, category_id, priority, status, task_count, duration_hours_sum, duration_count) "
+        "SELECT d, IFNULL(category_id, 0), IFNULL(priority, 2), IFNULL(status, 0), "
+        "COUNT(*), IFNULL(SUM(h), 0), COUNT(h) "
+        "FROM (SELECT category_id, priority, status, "
+        "CASE WHEN status = 2 THEN date(completed_at) ELSE date(deadline) END AS d, "
+        "CASE WHEN status = 2 THEN (julianday(completed_at) - julianday(created_at)) * 24 END AS h "
+        "FROM " + source + " WHERE " + filter + ") "
+        "WHERE d IS NOT NULL "
+        "GROUP BY d, IFNULL(category_id, 0), IFNULL(priority, 2), IFNULL(status, 0)";
+    if (accumulate) {
+        sql += " ON CONFLICT(day, category_id, priority, status) DO UPDATE SET "
+               "task_count = task_count + excluded.task_count, "
+               "duration_hours_sum = duration_hours_sum + excluded.duration_hours_sum, "
+               "duration_count = duration_count + excluded.duration_count";
+    }
+    return sql;
+}
+
+static QString sketchInsertSql(const QString &source, const QString &filter, bool accumulate)
+{
+    QString sql =
+        "INSERT INTO task_duration_sketch "
+        "(day, category_id, priority, metric, bucket, sample_count) "
+        "SELECT d, c, p, m, " + sketchBucketExpr("h") + " AS b, COUNT(*) FROM ("
+        "SELECT date(completed_at) AS d, IFNULL(category_id, 0) AS c, IFNULL(priority, 2) AS p, "
+        "0 AS m, " + sketchLeadExpr("s") + " AS h FROM " + source + " s WHERE " + filter + " AND status = 2 "
+        "UNION ALL "
+        "SELECT date(completed_at), IFNULL(category_id, 0), IFNULL(priority, 2), "
+        "1, " + sketchCompletionExpr("s") + " FROM " + source + " s WHERE " + filter + " AND status = 2) "
+        "WHERE d IS NOT NULL AND h IS NOT NULL "
+        "GROUP BY d, c, p, m, b";
+    if (accumulate) {
+        sql += " ON CONFLICT(day, category_id, priority, metric, bucket) DO UPDATE SET "
+               "sample_count = sample_count + excluded.sample_count";
+    }
+    return sql;
+}
+
+bool Database::rebuildDailyRollup()
+{
+    if (!db.isOpen()) {
+        qDebug() << "数据库未打开，无法重建统计汇总";
+        return false;
+    }
+
+    // 归档任务已从 tasks 移走，汇总仍需包含它们
+    QString source = archiveAttached ? "all_tasks" : "tasks";
+
+    QSqlQuery query(db);
+    if (!query.exec("DELETE FROM task_daily_rollup")) {
+        qDebug() << "清空统计汇总失败:" << query.lastError().text();
+        return false;
+    }
+
+    bool ok = query.exec(rollupInsertSql(source, "is_deleted = 0", false));
+    if (!ok) {
+        qDebug() << "重建统计汇总失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 耗时分布草图与汇总表一起重建；旧库升级前表还不存在，此时跳过
+    if (db.tables().contains("task_duration_sketch")) {
+        ok = query.exec("DELETE FROM task_duration_sketch")
+             && query.exec(sketchInsertSql(source, "is_deleted = 0", false));
+        if (!ok) {
+            qDebug() << "重建耗时分布失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    qDebug() << "统计汇总表已重建";
+    markDataChanged();
+    return true;
+}
+
+QString Database::archivePath() const
+{
+    return QFileInfo(dbPath).dir().filePath("archive.db");
+}
+
+bool Database::isArchiveAttached() const
+{
+    return archiveAttached;
+}
+
+static QList<QPair<QString, QString>> tableColumns(QSqlDatabase &connection, const QString &schema, const QString &table)
+{
+    QList<QPair<QString, QString>> columns;
+    QSqlQuery query(connection);
+    if (query.exec(QString("PRAGMA %1.table_info(%2)").arg(schema, table))) {
+        while (query.next()) {
+            columns.append({query.value("name").toString(), query.value("type").toString()});
+        }
+    }
+    return columns;
+}
+
+bool Database::attachArchive(QSqlDatabase &connection, const QString &archivePath)
+{
+    QSqlQuery query(connection);
+    // 已附加时（如主库结构升级之后）只重新补齐结构和视图
+    bool attached = false;
+    if (query.exec("PRAGMA database_list")) {
+        while (query.next()) attached = attached || query.value("name").toString() == "archive";
+    }
+    if (!attached) {
+        query.prepare("ATTACH DATABASE ? AS archive");
+        query.addBindValue(archivePath);
+        if (!query.exec()) {
+            qDebug() << "附加归档库失败:" << query.lastError().text();
+            return false;
+        }
+    }
+
+    // 归档表不带外键和自增，列按主库顺序补齐；主库以后新增的列也会在这里追加
+    bool ok = query.exec("CREATE TABLE IF NOT EXISTS archive.tasks (id INTEGER PRIMARY KEY)");
+    QList<QPair<QString, QString>> archived = tableColumns(connection, "archive", "tasks");
+    QStringList columnNames;
+    for (const auto &column : tableColumns(connection, "main", "tasks")) {
+        columnNames << column.first;
+        bool exists = std::any_of(archived.begin(), archived.end(),
+                                  [&](const QPair<QString, QString> &c) { return c.first == column.first; });
+        if (ok && !exists) {
+            ok = query.exec(QString("ALTER TABLE archive.tasks ADD COLUMN %1 %2").arg(column.first, column.second));
+        }
+    }
+
+    ok = ok
+         && query.exec("CREATE TABLE IF NOT EXISTS archive.task_tag_relations ("
+                       "task_id INTEGER NOT NULL, "
+                       "tag_id INTEGER NOT NULL, "
+                       "created_at DATETIME, "
+                       "PRIMARY KEY (task_id, tag_id))")
+         && query.exec("CREATE INDEX IF NOT EXISTS archive.idx_tasks_deadline ON tasks (deadline)")
+         && query.exec("CREATE INDEX IF NOT EXISTS archive.idx_tasks_completed_at ON tasks (completed_at)")
+         // 导入时按外部编号在归档库中去重；升级前主库还没有该列
+         && (!columnNames.contains("external_id")
+             || query.exec("CREATE INDEX IF NOT EXISTS archive.idx_tasks_external_id ON tasks (external_id)"));
+
+    // 视图建在 TEMP 中才能跨库引用，只对当前连接可见
+    QString columns = columnNames.join(", ");
+    ok = ok
+         && query.exec("DROP VIEW IF EXISTS temp.all_tasks")
+         && query.exec(QString("CREATE TEMP VIEW all_tasks AS "
+                               "SELECT %1 FROM main.tasks UNION ALL SELECT %1 FROM archive.tasks").arg(columns))
+         && query.exec("CREATE TEMP VIEW IF NOT EXISTS all_task_tag_relations AS "
+                       "SELECT task_id, tag_id, created_at FROM main.task_tag_relations "
+                       "UNION ALL SELECT task_id, tag_id, created_at FROM archive.task_tag_relations");
+
+    if (!ok) {
+        qDebug() << "初始化归档库失败:" << query.lastError().text();
+        query.exec("DETACH DATABASE archive");
+    }
+    return ok;
+}
+
+int Database::archiveBatch(QSqlDatabase &connection, const QDateTime &cutoff, int batchSize)
+{
+    QStringList columnNames;
+    for (const auto &column : tableColumns(connection, "main", "tasks")) columnNames << column.first;
+    QString columns = columnNames.join(", ");
+
+    // 本批任务编号先放进临时表，后续几步都针对同一批
+    QSqlQuery query(connection);
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS archive_batch (id INTEGER PRIMARY KEY)")) {
+        qDebug() << "归档任务失败:" << query.lastError().text();
+        return -1;
+    }
+    // 主库和归档库在同一个事务中提交，任务不会丢失或重复
+    if (!connection.transaction()) return -1;
+
+    bool ok = query.exec("DELETE FROM temp.archive_batch");
+    if (ok) {
+        query.prepare("INSERT INTO temp.archive_batch (id) SELECT id FROM main.tasks "
+                      "WHERE status = 2 AND is_deleted = 0 AND completed_at < ? ORDER BY completed_at LIMIT ?");
+        query.addBindValue(cutoff);
+        query.addBindValue(batchSize);
+        ok = query.exec();
+    }
+    int moved = ok ? query.numRowsAffected() : 0;
+
+    const QString batch = "(SELECT id FROM temp.archive_batch)";
+    if (ok && moved > 0) {
+        ok = query.exec("INSERT OR REPLACE INTO archive.task_tag_relations (task_id, tag_id, created_at) "
+                        "SELECT task_id, tag_id, created_at FROM main.task_tag_relations WHERE task_id IN " + batch)
+             // 不用 OR REPLACE：编号冲突时宁可本批失败，也不覆盖已归档的任务
+             && query.exec(QString("INSERT INTO archive.tasks (%1) SELECT %1 FROM main.tasks WHERE id IN ")
+                               .arg(columns) + batch)
+             // 标签关联随外键级联删除；删除触发器会从汇总和耗时分布中减去这些任务
+             && query.exec("DELETE FROM main.tasks WHERE id IN " + batch)
+             // 归档任务仍计入统计，按移走的行加回
+             && query.exec(rollupInsertSql("archive.tasks", "is_deleted = 0 AND id IN " + batch, true))
+             && (!connection.tables().contains("task_duration_sketch")
+                 || query.exec(sketchInsertSql("archive.tasks", "is_deleted = 0 AND id IN " + batch, true)));
+    }
+
+    if (!ok) {
+        qDebug() << "归档任务失败:" << query.lastError().text();
+        connection.rollback();
+        return -1;
+    }
+    if (!connection.commit()) {
+        qDebug() << "归档任务提交失败:" << connection.lastError().text();
+        connection.rollback();
+        return -1;
+    }
+    return moved;
+}
+
+bool Database::reconcileArchive()
+{
+    // 备份只含主库，恢复旧备份后会出现两种情况：
+    // 1. 归档之前的备份：同一任务（编号和创建时间都相同）同时在主库和归档库，以主库为准删掉归档中的副本；
+    // 2. 自增序号回退到归档任务之下，新任务复用了归档任务的编号：给归档任务换一个新编号，两边都保留。
+    // 最后把 tasks 的自增序号抬到两库的最大编号之上，之后新建的任务不会再撞号
+    QSqlQuery query(db);
+    const QString maxId = "MAX(IFNULL((SELECT MAX(id) FROM main.tasks), 0), "
+                          "IFNULL((SELECT MAX(id) FROM archive.tasks), 0), "
+                          "IFNULL((SELECT seq FROM main.sqlite_sequence WHERE name = 'tasks'), 0))";
+    const QString duplicate = "SELECT a.id FROM archive.tasks a JOIN main.tasks m "
+                              "ON m.id = a.id AND m.created_at IS a.created_at";
+
+    if (!beginTransaction()) return false;
+    bool ok = query.exec("DELETE FROM archive.task_tag_relations WHERE task_id IN (" + duplicate + ")")
+              && query.exec("DELETE FROM archive.tasks WHERE id IN (" + duplicate + ")");
+    int removed = ok ? query.numRowsAffected() : 0;
+
+    int renumbered = 0;
+    ok = ok
+         && query.exec("CREATE TEMP TABLE IF NOT EXISTS archive_remap (old_id INTEGER PRIMARY KEY, new_id INTEGER)")
+         && query.exec("DELETE FROM temp.archive_remap")
+         && query.exec("INSERT INTO temp.archive_remap (old_id, new_id) "
+                       "SELECT id, " + maxId + " + ROW_NUMBER() OVER (ORDER BY id) "
+                       "FROM archive.tasks WHERE id IN (SELECT id FROM main.tasks)");
+    if (ok) renumbered = query.numRowsAffected();
+
+    const QString remapped = "(SELECT old_id FROM temp.archive_remap)";
+    ok = ok
+         && query.exec("UPDATE archive.task_tag_relations SET task_id = "
+                       "(SELECT new_id FROM temp.archive_remap WHERE old_id = task_id) WHERE task_id IN " + remapped)
+         && query.exec("UPDATE archive.tasks SET id = "
+                       "(SELECT new_id FROM temp.archive_remap WHERE old_id = id) WHERE id IN " + remapped)
+         && query.exec("INSERT INTO main.sqlite_sequence (name, seq) SELECT 'tasks', 0 "
+                       "WHERE NOT EXISTS (SELECT 1 FROM main.sqlite_sequence WHERE name = 'tasks')")
+         && query.exec("UPDATE main.sqlite_sequence SET seq = " + maxId + " WHERE name = 'tasks'");
+
+    if (!ok) {
+        qDebug() << "核对归档库失败:" << query.lastError().text();
+        rollbackTransaction();
+        return false;
+    }
+    if (!commitTransaction()) return false;
+
+    if (renumbered > 0) {
+        qDebug() << "归档任务与主库任务编号冲突，已为归档任务重新编号:" << renumbered;
+    }
+    // 重复的任务在汇总中计了两次
+    if (removed > 0) {
+        qDebug() << "已移除归档库中与主库重复的任务:" << removed;
+        return rebuildDailyRollup();
+    }
+    return true;
+}
+
 void Database::initDefaultData()
 {
     if (getSetting("first_run").isEmpty()) {
@@ -166,6 +720,18 @@ void Database::initDefaultData()
     }
 }
 
+bool Database::startNewBackupChain(QSqlDatabase &connection)
+{
+    QSqlQuery query(connection);
+    query.prepare("INSERT OR REPLACE INTO user_settings (key, value, updated_at) VALUES ('backup_chain_id', ?, CURRENT_TIMESTAMP)");
+    query.addBindValue(QUuid::createUuid().toString(QUuid::WithoutBraces));
+    if (!query.exec()) {
+        qDebug() << "更新备份组标识失败:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 QSqlDatabase Database::getDatabase()
 {
     return db;
@@ -179,7 +745,7 @@ bool Database::executeQuery(const QString& query)
     }
 
     QSqlQuery sqlQuery(db);
-    if (!sqlQuery.exec(query)) {
+    if (!QueryProfiler::exec(sqlQuery, query, "Database")) {
         qDebug() << "Query execution error:" << sqlQuery.lastError().text();
         qDebug() << "Query:" << query;
         qDebug() << "Database error:" << sqlQuery.lastError().databaseText();
@@ -196,7 +762,7 @@ QSqlQuery Database::executeSelect(const QString& query)
     }
 
     QSqlQuery sqlQuery(db);
-    if (!sqlQuery.exec(query)) {
+    if (!QueryProfiler::exec(sqlQuery, query, "Database")) {
         qDebug() << "Select execution error:" << sqlQuery.lastError().text();
         qDebug() << "Query:" << query;
     }
@@ -217,7 +783,7 @@ QSqlQuery Database::prepareQuery(const QString& query)
 
 bool Database::executePreparedQuery(QSqlQuery &query)
 {
-    if (!query.exec()) {
+    if (!QueryProfiler::exec(query, "Database")) {
         qDebug() << "预编译查询执行错误:" << query.lastError().text();
         qDebug() << "SQL:" << query.lastQuery();
         return false;
@@ -395,31 +961,132 @@ bool Database::ensureConnected()
     return true;
 }
 
-bool Database::backupDatabase(const QString &destPath)
+quint64 Database::dataVersion() const
+{
+    return dataVersionCounter.loadAcquire();
+}
+
+void Database::markDataChanged()
 {
-    if (QFile::exists(destPath)) {
-        QFile::remove(destPath);
+    dataVersionCounter.fetchAndAddOrdered(1);
+    notifyChanges();
+}
+
+QList<ChangeLogEntry> Database::changesSince(qint64 seq) const
+{
+    QList<ChangeLogEntry> changes;
+    if (!db.isOpen()) return changes;
+
+    // SQLite 中与 MAX() 同查的裸列取自最大值所在的行，即每行最后一次变化的 op
+    QSqlQuery query(db);
+    query.prepare("SELECT MAX(seq), table_name, row_id, op FROM change_log WHERE seq > ? "
+                  "GROUP BY table_name, row_id ORDER BY 1");
+    query.addBindValue(seq);
+    if (query.exec()) {
+        while (query.next()) {
+            ChangeLogEntry entry;
+            entry.seq = query.value(0).toLongLong();
+            entry.table = query.value(1).toString();
+            entry.rowId = query.value(2).toInt();
+            QString op = query.value(3).toString();
+            if (!op.isEmpty()) entry.op = op.at(0).toLatin1();
+            changes.append(entry);
+        }
     }
+    return changes;
+}
+
+qint64 Database::latestChangeSeq() const
+{
     QSqlQuery query(db);
-    if (query.exec(QString("VACUUM INTO '%1'").arg(destPath))) {
-        return true;
+    if (query.exec("SELECT IFNULL(MAX(seq), 0) FROM change_log") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return 0;
+}
+
+void Database::notifyChanges()
+{
+    if (changesPending.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, &Database::publishChanges, Qt::QueuedConnection);
     }
+}
 
-    return QFile::copy(dbPath, destPath);
+qint64 Database::readDataVersion()
+{
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA data_version") && query.next()) {
+        return query.value(0).toLongLong();
+    }
+    return lastDataVersion;
 }
 
-bool Database::restoreDatabase(const QString &srcPath)
+// data_version 只在其他连接提交后变化，本连接自己的写入不会触发
+void Database::checkExternalChanges()
 {
-    if (db.isOpen()) db.close();
+    if (!db.isOpen()) return;
+
+    qint64 version = readDataVersion();
+    if (version == lastDataVersion) return;
+    lastDataVersion = version;
+
+    // 其他进程的写入不会调用 markDataChanged，这里代为使统计缓存失效并同步变化
+    markDataChanged();
+}
 
-    if (QFile::exists(dbPath)) {
-        QFile::remove(dbPath);
+qint64 Database::publishedChangeSeq() const
+{
+    return publishedSeq.loadAcquire();
+}
+
+void Database::publishChanges()
+{
+    changesPending.storeRelease(0);
+
+    QList<ChangeLogEntry> changes = changesSince(publishedSeq.loadAcquire());
+    if (changes.isEmpty()) return;
+    publishedSeq.storeRelease(changes.last().seq);
+    emit changesAvailable(changes);
+}
+
+bool Database::backupDatabase(const QString &destPath)
+{
+    return BackupEngine::onlineBackup(dbPath, destPath);
+}
+
+Database::ReplaceResult Database::replaceDatabase(const QString &stagedPath)
+{
+    emit aboutToReplaceDatabase();
+
+    if (db.isOpen()) {
+        QString connectionName = db.connectionName();
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
     }
 
-    if (QFile::copy(srcPath, dbPath)) {
-        return initDatabase();
+    // 旧库残留的日志文件不能套用到新库上
+    for (const QString &suffix : {"-journal", "-wal", "-shm"}) {
+        QFile::remove(dbPath + suffix);
     }
-    return false;
+
+    // 同一目录内重命名覆盖是原子的，任何时刻数据库文件都存在
+    std::error_code error;
+    std::filesystem::rename(QFile(stagedPath).filesystemFileName(), QFile(dbPath).filesystemFileName(), error);
+    if (error) {
+        qDebug() << "替换数据库文件失败:" << QString::fromStdString(error.message());
+    }
+
+    // 整库替换后所有统计缓存都失效；替换失败时重新打开原数据库
+    markDataChanged();
+    bool opened = initDatabase();
+    if (!opened) qDebug() << "替换后打开数据库失败";
+    // 恢复出的变更日志序号属于另一段历史，不能再在原来的完整备份上做差异备份
+    if (opened && !error) startNewBackupChain(db);
+    emit databaseReplaced();
+
+    if (error) return ReplaceFileFailed;
+    return opened ? ReplaceOk : ReplaceOpenFailed;
 }
 
 void Database::setSetting(const QString &key, const QString &value)
@@ -449,7 +1116,9 @@ int Database::updateOverdueTasks()
     query.prepare("UPDATE tasks SET status = 3, updated_at = CURRENT_TIMESTAMP "
                   "WHERE status != 2 AND status != 3 AND deadline < CURRENT_TIMESTAMP AND is_deleted = 0");
     if (query.exec()) {
-        return query.numRowsAffected();
+        int affected = query.numRowsAffected();
+        if (affected > 0) markDataChanged();
+        return affected;
     }
     return 0;
 }
@@ -457,7 +1126,9 @@ int Database::updateOverdueTasks()
 bool Database::clearCategories()
 {
     QSqlQuery query(db);
-    return query.exec("DELETE FROM task_categories");
+    if (!query.exec("DELETE FROM task_categories")) return false;
+    markDataChanged();
+    return true;
 }
 
 bool Database::deleteCategory(int id)
@@ -465,5 +1136,7 @@ bool Database::deleteCategory(int id)
     QSqlQuery query(db);
     query.prepare("DELETE FROM task_categories WHERE id = ?");
     query.addBindValue(id);
-    return query.exec();
+    if (!query.exec()) return false;
+    markDataChanged();
+    return true;
 }
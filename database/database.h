@@ -8,6 +8,15 @@
 #include <QDebug>
 #include <QDir>
 #include <QStandardPaths>
+#include <QAtomicInteger>
+
+// change_log 中一行数据的最近一次变化，op 为 'I' / 'U' / 'D'
+struct ChangeLogEntry {
+    qint64 seq = 0;
+    QString table;
+    int rowId = 0;
+    char op = 'U';
+};
 
 class Database : public QObject
 {
@@ -32,12 +41,33 @@ public:
     bool removeTaskTagRelation(int taskId, int tagId);
     QList<QVariantMap> getTasksByTagId(int tagId);
     bool backupDatabase(const QString &destPath);
-    bool restoreDatabase(const QString &srcPath);
+    enum ReplaceResult {
+        ReplaceOk,
+        ReplaceFileFailed,   // 文件没有替换，已重新打开原数据库
+        ReplaceOpenFailed    // 文件已替换，但打开或初始化新数据库失败
+    };
+    // 用已校验过的数据库文件原子替换当前数据库并重新打开，成功替换时 stagedPath 会被移走
+    ReplaceResult replaceDatabase(const QString &stagedPath);
 
     void setSetting(const QString &key, const QString &value);
     QString getSetting(const QString &key, const QString &defaultValue = "");
 
     int updateOverdueTasks();
+    bool rebuildDailyRollup();
+
+    // 归档库：早于截止时间完成的任务移到数据库旁的 archive.db，日常加载只读主库
+    QString archivePath() const;
+    bool isArchiveAttached() const;
+    // 在 connection 上把 cutoff 之前完成的任务最多 batchSize 个连同标签关联移入归档库（单个事务），
+    // 统计汇总保持不变；返回移动的任务数，失败返回 -1。connection 需已附加归档库并开启外键
+    static int archiveBatch(QSqlDatabase &connection, const QDateTime &cutoff, int batchSize);
+    // 在 connection 上附加归档库（别名 archive），补齐与主库一致的表结构，
+    // 并建立该连接可见的合并视图 all_tasks 和 all_task_tag_relations
+    static bool attachArchive(QSqlDatabase &connection, const QString &archivePath);
+
+    // 定时备份组的标识，写在 user_settings 中并随完整备份一起保存；变化序号另起一段历史时
+    // （恢复备份、整库 VACUUM 改变结构版本）换一个新标识，下一次定时备份据此改做完整备份
+    static bool startNewBackupChain(QSqlDatabase &connection);
 
     bool clearCategories();
     bool deleteCategory(int id);
@@ -47,6 +77,32 @@ public:
     bool rollbackTransaction();
     bool ensureConnected();
 
+    // 任务/灵感数据每次写入后递增，供统计缓存判断是否失效（线程安全）
+    quint64 dataVersion() const;
+    // 同时调用 notifyChanges()
+    void markDataChanged();
+
+    // seq 之后的变化，每行只保留最后一次，按 seq 升序（主连接，仅界面线程调用）
+    QList<ChangeLogEntry> changesSince(qint64 seq) const;
+    qint64 latestChangeSeq() const;
+    // 已通过 changesAvailable 发出的最大 seq，此前的变更日志界面已不再需要（线程安全）
+    qint64 publishedChangeSeq() const;
+    // 在界面线程的下一轮事件循环中发出 changesAvailable，多次调用合并为一次（线程安全）
+    void notifyChanges();
+
+    // 由 change_log 记录变化的表及其行键列（task_tag_relations 以 task_id 为键，同一任务的关联整体记录）
+    static const QList<QPair<QString, QString>> &changeLogTables();
+
+    // 当前程序的数据库结构版本，即 upgradeSchema 的最后一步
+    static const int SchemaVersion = 5;
+
+signals:
+    // 替换数据库文件前后发出：持有数据库连接的模型和后台线程在前者中释放连接，在后者中重新打开并刷新
+    void aboutToReplaceDatabase();
+    void databaseReplaced();
+    // 自上次发出以来的变化，各组件据此增量更新，已自行同步过的部分按 seq 跳过
+    void changesAvailable(const QList<ChangeLogEntry> &changes);
+
 private:
     explicit Database(QObject *parent = nullptr);
     ~Database();
@@ -56,9 +112,27 @@ private:
 
     void createTables();
     void initDefaultData();
+    void upgradeSchema();
+    void createDailyRollup();
+    void createDurationSketch();
+    void createChangeLog();
 
     QSqlDatabase db;
     QString dbPath;
+    bool archiveAttached;
+    QAtomicInteger<quint64> dataVersionCounter;
+    QAtomicInt changesPending;
+    QAtomicInteger<qint64> publishedSeq;
+
+    // 轮询主连接的 PRAGMA data_version，发现其他连接（后台线程、其他进程）提交的写入
+    class QTimer *dataVersionTimer;
+    qint64 lastDataVersion;
+
+    // 恢复旧备份后核对归档库：删除与主库重复的任务、为编号冲突的归档任务重新编号，并抬高自增序号
+    bool reconcileArchive();
+    void publishChanges();
+    qint64 readDataVersion();
+    void checkExternalChanges();
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,259 @@
+#include "queryprofiler.h"
+#include <QSqlDriver>
+#include <QSqlResult>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 慢查询日志超过该大小时轮转，保留 kLogFiles 个历史文件
+const qint64 kMaxLogBytes = 1024 * 1024;
+const int kLogFiles = 3;
+
+} // namespace
+
+QueryProfiler::QueryProfiler() : m_enabled(0), m_slowThresholdMs(100)
+{
+}
+
+QueryProfiler& QueryProfiler::instance()
+{
+    static QueryProfiler profiler;
+    return profiler;
+}
+
+const QVector<int> &QueryProfiler::bucketBoundsMs()
+{
+    static const QVector<int> bounds = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+    return bounds;
+}
+
+bool QueryProfiler::exec(QSqlQuery &query, const char *component)
+{
+    if (!instance().isEnabled()) return query.exec();
+    return execProfiled(query, nullptr, component);
+}
+
+bool QueryProfiler::exec(QSqlQuery &query, const QString &sql, const char *component)
+{
+    if (!instance().isEnabled()) return query.exec(sql);
+    return execProfiled(query, &sql, component);
+}
+
+bool QueryProfiler::execProfiled(QSqlQuery &query, const QString *sql, const char *component)
+{
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = sql ? query.exec(*sql) : query.exec();
+
+    // 查询语句把取完全部结果的时间也算进去，再回到第一行之前，调用方照常 next()；
+    // 只进查询无法回退，只计 exec 的耗时，行数记为 -1（报表中显示为未读取）
+    int rows = -1;
+    if (ok && query.isSelect()) {
+        if (!query.isForwardOnly()) {
+            rows = query.last() ? query.at() + 1 : 0;
+            query.seek(-1);
+        }
+    } else if (ok) {
+        rows = query.numRowsAffected();
+    }
+    qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+    QueryProfiler &profiler = instance();
+    profiler.record(component, query.lastQuery(), query.boundValues().size(), elapsedUs, rows);
+    if (elapsedUs >= (qint64)profiler.m_slowThresholdMs.loadRelaxed() * 1000) {
+        profiler.logSlowQuery(component, query, elapsedUs, rows);
+    }
+    return ok;
+}
+
+void QueryProfiler::setEnabled(bool enabled)
+{
+    m_enabled.storeRelaxed(enabled ? 1 : 0);
+}
+
+bool QueryProfiler::isEnabled() const
+{
+    return m_enabled.loadRelaxed() != 0;
+}
+
+void QueryProfiler::setSlowThresholdMs(int ms)
+{
+    m_slowThresholdMs.storeRelaxed(qMax(1, ms));
+}
+
+void QueryProfiler::setLogPath(const QString &path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_logPath = path;
+}
+
+QString QueryProfiler::logPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_logPath;
+}
+
+QString QueryProfiler::fingerprint(const QString &sql)
+{
+    static const QRegularExpression stringLiteral("'(?:[^']|'')*'");
+    static const QRegularExpression numberLiteral("\\b\\d+(?:\\.\\d+)?\\b");
+    static const QRegularExpression placeholderList("\\(\\s*\\?(?:\\s*,\\s*\\?)+\\s*\\)");
+    static const QRegularExpression whitespace("\\s+");
+
+    QString result = sql;
+    result.replace(stringLiteral, "?");
+    result.replace(numberLiteral, "?");
+    result.replace(whitespace, " ");
+    // IN (?, ?, ...) 的参数个数不同也归为同一条
+    result.replace(placeholderList, "(?+)");
+    return result.trimmed();
+}
+
+void QueryProfiler::record(const char *component, const QString &sql, int bindCount, qint64 elapsedUs, int rows)
+{
+    QString print = fingerprint(sql);
+    const QVector<int> &bounds = bucketBoundsMs();
+    int bucket = std::upper_bound(bounds.begin(), bounds.end(), (int)(elapsedUs / 1000)) - bounds.begin();
+
+    QMutexLocker locker(&m_mutex);
+    Stats &stats = m_stats[QString::fromLatin1(component) + '\n' + print];
+    if (stats.count == 0) {
+        stats.component = QString::fromLatin1(component);
+        stats.fingerprint = print;
+        stats.histogram.fill(0, bounds.size() + 1);
+    }
+    stats.bindCount = bindCount;
+    stats.count++;
+    stats.totalUs += elapsedUs;
+    stats.maxUs = qMax(stats.maxUs, elapsedUs);
+    if (rows > 0) stats.rows += rows;
+    if (rows < 0) stats.unfetched++;
+    stats.histogram[bucket]++;
+}
+
+void QueryProfiler::logSlowQuery(const char *component, QSqlQuery &query, qint64 elapsedUs, int rows)
+{
+    QString sql = query.lastQuery();
+    QVariantList bindings = query.boundValues();
+
+    // 在同一连接上取执行计划，参数按原值绑定，DDL 和 PRAGMA 没有计划可查
+    QStringList plan;
+    static const QRegularExpression explainable("^\\s*(SELECT|WITH|INSERT|REPLACE|UPDATE|DELETE)\\b",
+                                                QRegularExpression::CaseInsensitiveOption);
+    if (query.driver() && explainable.match(sql).hasMatch()) {
+        QSqlQuery planQuery(query.driver()->createResult());
+        planQuery.prepare("EXPLAIN QUERY PLAN " + sql);
+        for (const QVariant &value : bindings) planQuery.addBindValue(value);
+        if (planQuery.exec()) {
+            while (planQuery.next()) plan << "  " + planQuery.value(3).toString();
+        } else {
+            plan << "  (无法获取执行计划: " + planQuery.lastError().text() + ")";
+        }
+    }
+
+    QString entry;
+    QTextStream out(&entry);
+    out << QDateTime::currentDateTime().toString(Qt::ISODate)
+        << " [" << component << "] "
+        << QString::number(elapsedUs / 1000.0, 'f', 1) << " ms, "
+        << (rows < 0 ? QString("未读取") : QString("%1 行").arg(rows)) << ", "
+        << bindings.size() << " 个参数\n"
+        << sql.simplified() << "\n";
+    for (const QString &line : plan) out << line << "\n";
+    out << "\n";
+    out.flush();
+
+    QString path = logPath();
+    if (path.isEmpty()) return;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // 只有轮转和追加需要串行，与统计数据分用不同的锁，磁盘 I/O 不会挡住其他线程的查询
+    QMutexLocker locker(&m_logMutex);
+    rotateLog(path);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "无法写入慢查询日志:" << path;
+        return;
+    }
+    file.write(entry.toUtf8());
+}
+
+void QueryProfiler::rotateLog(const QString &path)
+{
+    if (QFileInfo(path).size() < kMaxLogBytes) return;
+
+    QFile::remove(QString("%1.%2").arg(path).arg(kLogFiles));
+    for (int i = kLogFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(path).arg(i), QString("%1.%2").arg(path).arg(i + 1));
+    }
+    QFile::rename(path, path + ".1");
+}
+
+QList<QueryProfiler::Stats> QueryProfiler::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats.values();
+}
+
+void QueryProfiler::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stats.clear();
+}
+
+QString QueryProfiler::report(int limit) const
+{
+    QList<Stats> stats = snapshot();
+    std::sort(stats.begin(), stats.end(), [](const Stats &a, const Stats &b) { return a.totalUs > b.totalUs; });
+
+    const QVector<int> &bounds = bucketBoundsMs();
+    QStringList lines;
+    lines << QString("%1 %2 %3 %4 %5 %6  %7")
+                 .arg("总耗时ms", 10).arg("次数", 7).arg("平均ms", 8).arg("P95", 8)
+                 .arg("最大ms", 8).arg("行数", 8).arg("组件 / SQL");
+
+    for (int i = 0; i < stats.size() && i < limit; ++i) {
+        const Stats &s = stats.at(i);
+
+        // P95 取所在分桶的上限
+        qint64 target = (s.count * 95 + 99) / 100;
+        qint64 seen = 0;
+        QString p95 = QString(">%1").arg(bounds.last());
+        for (int b = 0; b < bounds.size(); ++b) {
+            seen += s.histogram.value(b);
+            if (seen >= target) {
+                p95 = QString("<%1").arg(bounds.at(b));
+                break;
+            }
+        }
+
+        // 只进查询没有读取结果，耗时只含 exec，行数未知
+        QString rowsText = s.unfetched == s.count ? QString("未读取")
+                                                  : QString::number(s.rows) + (s.unfetched > 0 ? "*" : "");
+
+        lines << QString("%1 %2 %3 %4 %5 %6  [%7] %8")
+                     .arg(s.totalUs / 1000.0, 10, 'f', 1)
+                     .arg(s.count, 7)
+                     .arg(s.totalUs / 1000.0 / s.count, 8, 'f', 2)
+                     .arg(p95, 8)
+                     .arg(s.maxUs / 1000.0, 8, 'f', 1)
+                     .arg(rowsText, 8)
+                     .arg(s.component, s.fingerprint);
+    }
+    if (stats.isEmpty()) {
+        lines << "暂无记录，开启查询分析后使用程序即可收集数据。";
+    } else {
+        lines << "" << "未读取 / *：包含只进查询，这些调用只计 exec 耗时，不含读取结果的时间和行数。";
+    }
+    return lines.join("\n");
+}
@@ -0,0 +1,65 @@
+#ifndef QUERYPROFILER_H
+#define QUERYPROFILER_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSqlQuery>
+
+// 查询性能分析：按 SQL 指纹统计耗时分布，超过阈值的查询连同执行计划写入慢查询日志
+// 关闭时 exec 直接转发给 QSqlQuery::exec，没有额外开销；可在多个线程的连接上同时使用
+class QueryProfiler
+{
+public:
+    // 每个 SQL 指纹（字面量替换为 ?）在某个组件中的累计数据
+    struct Stats {
+        QString component;
+        QString fingerprint;
+        int bindCount = 0;
+        qint64 count = 0;
+        qint64 totalUs = 0;
+        qint64 maxUs = 0;
+        qint64 rows = 0;
+        qint64 unfetched = 0;        // 只进查询未读取结果的次数，其耗时只含 exec
+        QVector<qint64> histogram;   // 按 bucketBoundsMs() 分桶，最后一桶为超出上限
+    };
+
+    static QueryProfiler& instance();
+
+    // 执行 query 并记录；component 为调用方名称，如 "TaskModel"
+    static bool exec(QSqlQuery &query, const char *component);
+    static bool exec(QSqlQuery &query, const QString &sql, const char *component);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    void setSlowThresholdMs(int ms);
+    void setLogPath(const QString &path);
+    QString logPath() const;
+
+    QList<Stats> snapshot() const;
+    // 按总耗时排序的文本报表
+    QString report(int limit = 30) const;
+    void reset();
+
+    static QString fingerprint(const QString &sql);
+    static const QVector<int> &bucketBoundsMs();
+
+private:
+    QueryProfiler();
+
+    QAtomicInt m_enabled;
+    QAtomicInt m_slowThresholdMs;
+    mutable QMutex m_mutex;
+    QMutex m_logMutex;
+    QHash<QString, Stats> m_stats;
+    QString m_logPath;
+
+    static bool execProfiled(QSqlQuery &query, const QString *sql, const char *component);
+    void record(const char *component, const QString &sql, int bindCount, qint64 elapsedUs, int rows);
+    void logSlowQuery(const char *component, QSqlQuery &query, qint64 elapsedUs, int rows);
+    void rotateLog(const QString &path);
+};
+
+#endif // QUERYPROFILER_H
@@ -15,10 +15,20 @@
 #include "views/statisticview.h"
 #include "models/statisticmodel.h"
 #include "threads/remindthread.h"
+#include "threads/importthread.h"
+#include "threads/backupthread.h"
+#include "threads/restorethread.h"
+#include "threads/purgethread.h"
+#include "threads/archivethread.h"
+#include "database/queryprofiler.h"
 #include "dialogs/firstrundialog.h"
+#include "utils/themepalette.h"
+#include "utils/stylesheetengine.h"
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QGroupBox>
 #include <QColorDialog>
+#include <QInputDialog>
 #include <QColor>
 #include <QStackedWidget>
 #include <QComboBox>
@@ -45,13 +55,15 @@
 #include <QListWidget>
 #include <QMouseEvent>
 #include <QTableWidget>
-#include <QProcess>
 #include <QScrollArea>
 #include <QFormLayout>
 #include <QGridLayout>
 #include <QDate>
 #include <QCloseEvent>
-#include <QSqlQuery>
+#include <QProgressDialog>
+#include <QPlainTextEdit>
+#include <QDialogButtonBox>
+#include <QFontDatabase>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -60,6 +72,11 @@ MainWindow::MainWindow(QWidget *parent)
     , inspirationModel(nullptr)
     , taskTableView(nullptr)
     , recycleBinDialog(nullptr)
+    , importThread(nullptr)
+    , backupThread(nullptr)
+    , restoreThread(nullptr)
+    , purgeThread(nullptr)
+    , archiveThread(nullptr)
 {
     Database::instance().initDatabase();
 
@@ -100,12 +117,54 @@ MainWindow::MainWindow(QWidget *parent)
         }
     }
 
-    remindThread = new RemindThread(this);
-    connect(remindThread, &RemindThread::taskOverdueUpdated, this, [this](){
-        QMetaObject::invokeMethod(this, "onRefreshTasksClicked", Qt::QueuedConnection);
+    startRemindThread();
+    startBackupThread();
+    startPurgeThread();
+    startArchiveThread();
+
+    // 恢复备份时先停下持有数据库连接的后台线程，换入新数据库后重新启动
+    connect(&Database::instance(), &Database::aboutToReplaceDatabase, this, [this](){
+        remindThread->stop();
+        remindThread->wait();
+        delete remindThread;
+        remindThread = nullptr;
+
+        backupThread->stop();
+        backupThread->wait();
+        delete backupThread;
+        backupThread = nullptr;
+
+        purgeThread->stop();
+        purgeThread->wait();
+        delete purgeThread;
+        purgeThread = nullptr;
+
+        archiveThread->stop();
+        archiveThread->wait();
+        delete archiveThread;
+        archiveThread = nullptr;
+    });
+    connect(&Database::instance(), &Database::databaseReplaced, this, [this](){
+        startRemindThread();
+        startBackupThread();
+        startPurgeThread();
+        startArchiveThread();
+
+        if (recycleBinDialog) recycleBinDialog->refreshDeletedTasks();
+        if (filterCategoryCombo) {
+            filterCategoryCombo->blockSignals(true);
+            filterCategoryCombo->clear();
+            filterCategoryCombo->addItem("所有分类", -1);
+            filterCategoryCombo->addItem("灵感记录✨", -2);
+            QList<QVariantMap> cats = Database::instance().getAllCategories();
+            for(const auto &cat : cats) {
+                filterCategoryCombo->addItem(cat["name"].toString(), cat["id"]);
+            }
+            filterCategoryCombo->setCurrentIndex(0);
+            filterCategoryCombo->blockSignals(false);
+        }
+        reloadSettings();
     });
-    connect(remindThread, &RemindThread::remindTask, this, &MainWindow::onTaskReminded);
-    remindThread->start();
 
     createWatermark();
     setupSystemTray();
@@ -120,6 +179,31 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    if (importThread) {
+        importThread->cancel();
+        importThread->wait();
+    }
+
+    if (restoreThread) {
+        restoreThread->cancel();
+        restoreThread->wait();
+    }
+
+    if (backupThread) {
+        backupThread->stop();
+        backupThread->wait();
+    }
+
+    if (purgeThread) {
+        purgeThread->stop();
+        purgeThread->wait();
+    }
+
+    if (archiveThread) {
+        archiveThread->stop();
+        archiveThread->wait();
+    }
+
     if (remindThread) {
         remindThread->stop();
         remindThread->wait();
@@ -606,27 +690,49 @@ void MainWindow::createSettingTab()
     rightLayout->setSpacing(10);
     rightLayout->setContentsMargins(20, 25, 20, 20);
 
-    QCheckBox *soundCheck = new QCheckBox("启用提示音效 (Beep)", rightGroup);
+    soundCheck = new QCheckBox("启用提示音效 (Beep)", rightGroup);
     soundCheck->setChecked(Database::instance().getSetting("sound_enabled", "true") == "true");
     connect(soundCheck, &QCheckBox::toggled, [](bool checked){
         Database::instance().setSetting("sound_enabled", checked ? "true" : "false");
     });
 
-    QCheckBox *popupCheck = new QCheckBox("启用托盘弹窗提醒", rightGroup);
+    popupCheck = new QCheckBox("启用托盘弹窗提醒", rightGroup);
     popupCheck->setChecked(Database::instance().getSetting("popup_enabled", "true") == "true");
     connect(popupCheck, &QCheckBox::toggled, [](bool checked){
         Database::instance().setSetting("popup_enabled", checked ? "true" : "false");
     });
 
-    autoPurgeCheck = new QCheckBox("退出时自动清空回收站", rightGroup);
+    autoPurgeCheck = new QCheckBox(QString("自动清理回收站中超过 %1 天的项目")
+                                   .arg(Database::instance().getSetting("auto_purge_days", "30")), rightGroup);
+    autoPurgeCheck->setToolTip("在后台分批永久删除，并回收数据库文件中的空闲空间");
     autoPurgeCheck->setChecked(Database::instance().getSetting("auto_purge_bin", "false") == "true");
-    connect(autoPurgeCheck, &QCheckBox::toggled, [](bool checked){
+    connect(autoPurgeCheck, &QCheckBox::toggled, this, [this](bool checked){
         Database::instance().setSetting("auto_purge_bin", checked ? "true" : "false");
+        if (checked && purgeThread) purgeThread->requestRun();
     });
 
     rightLayout->addWidget(soundCheck);
     rightLayout->addWidget(popupCheck);
+    autoBackupCheck = new QCheckBox("每天自动备份 (保留最近 5 组)", rightGroup);
+    autoBackupCheck->setToolTip("备份保存在数据库所在目录的 backups 文件夹，每周一次完整备份，其余为差异备份");
+    autoBackupCheck->setChecked(Database::instance().getSetting("auto_backup_enabled", "false") == "true");
+    connect(autoBackupCheck, &QCheckBox::toggled, [](bool checked){
+        Database::instance().setSetting("auto_backup_enabled", checked ? "true" : "false");
+    });
+
+    profilerCheck = new QCheckBox("记录查询耗时和慢查询日志", rightGroup);
+    profilerCheck->setToolTip(QString("超过 %1 ms 的查询连同执行计划写入 %2")
+                                  .arg(Database::instance().getSetting("slow_query_threshold_ms", "100"),
+                                       QDir::toNativeSeparators(QueryProfiler::instance().logPath())));
+    profilerCheck->setChecked(QueryProfiler::instance().isEnabled());
+    connect(profilerCheck, &QCheckBox::toggled, [](bool checked){
+        Database::instance().setSetting("query_profiler_enabled", checked ? "true" : "false");
+        QueryProfiler::instance().setEnabled(checked);
+    });
+
     rightLayout->addWidget(autoPurgeCheck);
+    rightLayout->addWidget(autoBackupCheck);
+    rightLayout->addWidget(profilerCheck);
 
     rightLayout->addStretch();
     QLabel *dataLabel = new QLabel("数据维护:", rightGroup);
@@ -642,8 +748,29 @@ void MainWindow::createSettingTab()
     restoreBtn->setCursor(Qt::PointingHandCursor);
     connect(restoreBtn, &QPushButton::clicked, this, &MainWindow::onRestoreDatabase);
 
+    QPushButton *importBtn = new QPushButton("导入任务", rightGroup);
+    importBtn->setCursor(Qt::PointingHandCursor);
+    connect(importBtn, &QPushButton::clicked, this, &MainWindow::onImportTasks);
+
+    QPushButton *rebuildStatsBtn = new QPushButton("重建统计", rightGroup);
+    rebuildStatsBtn->setCursor(Qt::PointingHandCursor);
+    connect(rebuildStatsBtn, &QPushButton::clicked, this, &MainWindow::onRebuildStatistics);
+
+    QPushButton *archiveBtn = new QPushButton("归档旧任务", rightGroup);
+    archiveBtn->setCursor(Qt::PointingHandCursor);
+    archiveBtn->setToolTip("设置自动归档的天数并立即归档一次；归档的任务移入 archive.db，统计中仍包含这些任务");
+    connect(archiveBtn, &QPushButton::clicked, this, &MainWindow::onArchiveTasks);
+
+    QPushButton *queryStatsBtn = new QPushButton("查询统计", rightGroup);
+    queryStatsBtn->setCursor(Qt::PointingHandCursor);
+    connect(queryStatsBtn, &QPushButton::clicked, this, &MainWindow::onShowQueryStats);
+
     dataBtnLayout->addWidget(backupBtn);
     dataBtnLayout->addWidget(restoreBtn);
+    dataBtnLayout->addWidget(importBtn);
+    dataBtnLayout->addWidget(rebuildStatsBtn);
+    dataBtnLayout->addWidget(archiveBtn);
+    dataBtnLayout->addWidget(queryStatsBtn);
     rightLayout->addLayout(dataBtnLayout);
 
     towersLayout->addWidget(leftGroup);
@@ -1071,66 +1198,19 @@ void MainWindow::resizeEvent(QResizeEvent *event)
 
 void MainWindow::loadStyleSheet()
 {
-    QString styleSheet;
-    QString path = ":/styles/mainwindow.qss";
-
-    QFile file(path);
-    if (file.open(QFile::ReadOnly | QFile::Text)) {
-        styleSheet = QString::fromUtf8(file.readAll());
-        file.close();
-    }
-
-    QString themeColorStr = Database::instance().getSetting("theme_color", "#657896");
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    bool isLight = (bgMode == "light");
-
-    QColor themeColor(themeColorStr);
-    QColor themeHover = themeColor.lighter(115);
-    QColor themePressed = themeColor.darker(110);
-
-    QString themeSelection = QString("rgba(%1, %2, %3, %4)")
-                                 .arg(themeColor.red())
-                                 .arg(themeColor.green())
-                                 .arg(themeColor.blue())
-                                 .arg(isLight ? 40 : 60);
-
-    QMap<QString, QString> palette;
-
-    if (isLight) {
-        // --- 浅色模式 ---
-        palette["@BG_MAIN@"]   = "#f5f7fa";
-        palette["@BG_SUB@"]    = "#ffffff";
-        palette["@BG_INPUT@"]  = "#ffffff";
-        palette["@BORDER@"]    = "#dcdfe6";
-        palette["@TEXT_MAIN@"] = "#303133";
-        palette["@TEXT_SUB@"]  = "#909399";
-        palette["@ICON_ARROW@"] = ":/icons/dark_down.png";
-    } else {
-        // --- 深色模式 ---
-        palette["@BG_MAIN@"]   = "#303030";
-        palette["@BG_SUB@"]    = "#454545";
-        palette["@BG_INPUT@"]  = "#383838";
-        palette["@BORDER@"]    = "#555555";
-        palette["@TEXT_MAIN@"] = "#ffffff";
-        palette["@TEXT_SUB@"]  = "#cccccc";
-        palette["@ICON_ARROW@"] = ":/icons/light_down.png";
-    }
+    const ThemePalette &themePalette = ThemePalette::instance();
+    QString variant = StyleSheetEngine::variantKey(themePalette.isLight(), themePalette.theme());
 
-    palette["@THEME@"]        = themeColor.name();
-    palette["@THEME_HOVER@"]  = themeHover.name();
-    palette["@THEME_PRESSED@"]= themePressed.name();
-    palette["@THEME_SELECTION@"] = themeSelection;
+    // 主题没变时不重新设置，避免所有控件重新 polish
+    if (variant == appliedStyleVariant) return;
 
-    for (auto it = palette.begin(); it != palette.end(); ++it) {
-        styleSheet.replace(it.key(), it.value(), Qt::CaseInsensitive);
-    }
-
-    qApp->setStyleSheet("");
-    qApp->setStyleSheet(styleSheet);
+    qApp->setStyleSheet(StyleSheetEngine::instance().styleSheet(themePalette.isLight(), themePalette.theme()));
+    appliedStyleVariant = variant;
 }
 
 void MainWindow::updateThemeColor()
 {
+    ThemePalette::instance().reload();
     loadStyleSheet();
 }
 
@@ -1270,6 +1350,56 @@ void MainWindow::onCalendarShowTasks(const QDate &date)
     dlg.exec();
 }
 
+void MainWindow::startRemindThread()
+{
+    remindThread = new RemindThread(this);
+    // 逾期状态的变化经由 change_log 增量同步到任务模型，这里只提示
+    connect(remindThread, &RemindThread::taskOverdueUpdated, this, [this](){
+        updateStatusBar("已更新逾期任务状态");
+    });
+    connect(remindThread, &RemindThread::remindTask, this, &MainWindow::onTaskReminded);
+    remindThread->start();
+}
+
+void MainWindow::startBackupThread()
+{
+    backupThread = new BackupThread(this);
+    connect(backupThread, &BackupThread::backupFinished, this, [this](bool success, bool scheduled, const QString &filePath){
+        if (scheduled) {
+            updateStatusBar(success ? QString("已自动备份到 %1").arg(QFileInfo(filePath).fileName()) : "自动备份失败");
+        }
+    });
+    backupThread->start();
+}
+
+void MainWindow::startPurgeThread()
+{
+    purgeThread = new PurgeThread(this);
+    connect(purgeThread, &PurgeThread::purgeFinished, this, [this](int taskCount, int inspirationCount){
+        if (recycleBinDialog && recycleBinDialog->isVisible()) recycleBinDialog->refreshDeletedTasks();
+        updateStatusBar(QString("已自动清理回收站: %1 个任务, %2 条灵感").arg(taskCount).arg(inspirationCount));
+    });
+    purgeThread->start();
+}
+
+void MainWindow::startArchiveThread()
+{
+    archiveThread = new ArchiveThread(this);
+    connect(archiveThread, &ArchiveThread::archiveFinished, this, [this](int movedCount, bool manual){
+        // 任务列表通过变更日志同步，统计视图需要重新查询
+        if (movedCount > 0 && statisticView) statisticView->refresh();
+        if (movedCount < 0) {
+            updateStatusBar("归档任务失败");
+            if (manual) QMessageBox::warning(this, "失败", "归档任务失败，未完成的批次没有改动。");
+        } else if (manual) {
+            QMessageBox::information(this, "完成", QString("已归档 %1 个任务到 archive.db。").arg(movedCount));
+        } else {
+            updateStatusBar(QString("已自动归档 %1 个旧任务").arg(movedCount));
+        }
+    });
+    archiveThread->start();
+}
+
 void MainWindow::onBackupDatabase()
 {
     QString fileName = QFileDialog::getSaveFileName(this, "备份数据库",
@@ -1277,34 +1407,209 @@ void MainWindow::onBackupDatabase()
                                                     "Database Files (*.db)");
     if (fileName.isEmpty()) return;
 
-    if (Database::instance().backupDatabase(fileName)) {
-        QMessageBox::information(this, "成功", "数据库备份成功！");
+    // 在线备份分批复制，期间仍可正常编辑任务
+    if (!backupThread->requestBackup(fileName)) {
+        QMessageBox::information(this, "提示", "正在进行备份，请稍候再试。");
+        return;
+    }
+
+    QProgressDialog *progressDialog = new QProgressDialog("正在备份数据库...", QString(), 0, 100, this);
+    progressDialog->setWindowTitle("备份数据库");
+    progressDialog->setMinimumDuration(500);
+
+    connect(backupThread, &BackupThread::progressChanged, progressDialog, &QProgressDialog::setValue);
+    // 备份线程忙时不接受请求，因此下一次完成信号就是这次手动备份的结果
+    connect(backupThread, &BackupThread::backupFinished, this, [this, progressDialog](bool success) {
+        progressDialog->deleteLater();
+
+        if (success) {
+            QMessageBox::information(this, "成功", "数据库备份成功！");
+        } else {
+            QMessageBox::warning(this, "失败", "备份失败，请检查文件权限。");
+        }
+    }, Qt::SingleShotConnection);
+}
+
+void MainWindow::onImportTasks()
+{
+    if (importThread) {
+        QMessageBox::information(this, "提示", "上一次导入尚未完成，请稍候。");
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, "导入任务",
+                                                    QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+                                                    "任务数据 (*.csv *.jsonl);;CSV Files (*.csv);;JSON Lines Files (*.jsonl)");
+    if (fileName.isEmpty()) return;
+
+    QProgressDialog *progressDialog = new QProgressDialog("正在导入任务...", "取消", 0, 100, this);
+    progressDialog->setWindowTitle("导入任务");
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500);
+
+    // 解析和写库都在导入线程中完成，结束后刷新界面
+    importThread = new ImportThread(fileName, this);
+    connect(importThread, &ImportThread::progressChanged, progressDialog, &QProgressDialog::setValue);
+    connect(progressDialog, &QProgressDialog::canceled, importThread, &ImportThread::cancel, Qt::DirectConnection);
+    connect(importThread, &ImportThread::importFinished, this,
+            [this, progressDialog](bool success, bool canceled, int imported, int duplicates, int failed) {
+        progressDialog->deleteLater();
+        importThread->wait();
+        importThread->deleteLater();
+        importThread = nullptr;
+
+        if (taskModel) taskModel->refresh(false);
+        if (statisticView) statisticView->refresh();
+        if (filterCategoryCombo) {
+            int currentId = filterCategoryCombo->currentData().toInt();
+            filterCategoryCombo->blockSignals(true);
+            filterCategoryCombo->clear();
+            filterCategoryCombo->addItem("所有分类", -1);
+            filterCategoryCombo->addItem("灵感记录✨", -2);
+            QList<QVariantMap> cats = Database::instance().getAllCategories();
+            for(const auto &cat : cats) {
+                filterCategoryCombo->addItem(cat["name"].toString(), cat["id"]);
+            }
+            filterCategoryCombo->setCurrentIndex(qMax(0, filterCategoryCombo->findData(currentId)));
+            filterCategoryCombo->blockSignals(false);
+        }
+
+        QString summary = QString("新增 %1 条，重复跳过 %2 条，无效 %3 条。").arg(imported).arg(duplicates).arg(failed);
+        updateStatusBar(QString("任务导入%1 | %2").arg(success ? "完成" : (canceled ? "已取消" : "失败"), summary));
+        if (success) {
+            QMessageBox::information(this, "导入完成", summary);
+        } else if (canceled) {
+            QMessageBox::information(this, "导入已取消", "已提交的部分保留。\n" + summary);
+        } else {
+            QMessageBox::warning(this, "导入失败", "导入失败，请检查文件格式。\n" + summary);
+        }
+    });
+    importThread->start();
+}
+
+void MainWindow::onRebuildStatistics()
+{
+    if (Database::instance().rebuildDailyRollup()) {
+        if (statisticView) statisticView->refresh();
+        QMessageBox::information(this, "成功", "统计数据已重建。");
     } else {
-        QMessageBox::warning(this, "失败", "备份失败，请检查文件权限。");
+        QMessageBox::warning(this, "失败", "重建统计数据失败。");
+    }
+}
+
+void MainWindow::onArchiveTasks()
+{
+    if (!Database::instance().isArchiveAttached()) {
+        QMessageBox::warning(this, "失败", "归档数据库不可用，请检查数据目录权限。");
+        return;
+    }
+
+    bool ok = false;
+    int days = QInputDialog::getInt(this, "归档旧任务",
+                                    "自动归档完成时间早于多少天的任务 (0 表示不自动归档):",
+                                    Database::instance().getSetting("archive_after_days", "365").toInt(),
+                                    0, 3650, 30, &ok);
+    if (!ok) return;
+    Database::instance().setSetting("archive_after_days", QString::number(days));
+
+    if (days == 0) {
+        updateStatusBar("已关闭自动归档");
+        return;
     }
+    // 在后台分批移动，完成后由 archiveFinished 提示结果
+    if (archiveThread) archiveThread->requestRun();
+    updateStatusBar("正在归档旧任务...");
+}
+
+void MainWindow::onShowQueryStats()
+{
+    QDialog dlg(this);
+    dlg.setWindowTitle("查询统计");
+    dlg.resize(900, 500);
+    dlg.setWindowFlags(dlg.windowFlags() & ~Qt::WindowContextHelpButtonHint);
+    QVBoxLayout *layout = new QVBoxLayout(&dlg);
+
+    QLabel *hintLabel = new QLabel(QueryProfiler::instance().isEnabled()
+                                       ? QString("慢查询日志: %1").arg(QDir::toNativeSeparators(QueryProfiler::instance().logPath()))
+                                       : "查询分析未开启，请先在设置中勾选“记录查询耗时和慢查询日志”。", &dlg);
+    hintLabel->setWordWrap(true);
+    hintLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(hintLabel);
+
+    QPlainTextEdit *reportEdit = new QPlainTextEdit(QueryProfiler::instance().report(), &dlg);
+    reportEdit->setReadOnly(true);
+    reportEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    reportEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(reportEdit);
+
+    QDialogButtonBox *btnBox = new QDialogButtonBox(QDialogButtonBox::Close, &dlg);
+    QPushButton *resetBtn = btnBox->addButton("重置统计", QDialogButtonBox::ResetRole);
+    connect(resetBtn, &QPushButton::clicked, reportEdit, [reportEdit](){
+        QueryProfiler::instance().reset();
+        reportEdit->setPlainText(QueryProfiler::instance().report());
+    });
+    connect(btnBox, &QDialogButtonBox::rejected, &dlg, &QDialog::accept);
+    layout->addWidget(btnBox);
+
+    dlg.exec();
 }
 
 void MainWindow::onRestoreDatabase()
 {
+    if (restoreThread || importThread) {
+        QMessageBox::information(this, "提示", "当前有导入或恢复正在进行，请稍候。");
+        return;
+    }
+
     QString fileName = QFileDialog::getOpenFileName(this, "选择备份文件",
                                                     QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
                                                     "Database Files (*.db)");
     if (fileName.isEmpty()) return;
 
     if (QMessageBox::warning(this, "警告", "恢复操作将覆盖当前所有数据且不可撤销！\n确定要继续吗？",
-                             QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
+                             QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+        return;
+    }
 
-        if(remindThread) remindThread->stop();
+    QProgressDialog *progressDialog = new QProgressDialog("正在读取并校验备份...", "取消", 0, 100, this);
+    progressDialog->setWindowTitle("恢复数据");
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500);
+
+    // 备份先在后台还原到数据库旁的暂存文件并校验，当前数据在此期间照常可用
+    QString stagedPath = Database::instance().getDatabasePath() + ".restore";
+    restoreThread = new RestoreThread(fileName, stagedPath, this);
+    connect(restoreThread, &RestoreThread::progressChanged, progressDialog, &QProgressDialog::setValue);
+    connect(progressDialog, &QProgressDialog::canceled, restoreThread, &RestoreThread::cancel, Qt::DirectConnection);
+    connect(restoreThread, &RestoreThread::restoreReady, this,
+            [this, progressDialog, stagedPath](bool success, bool canceled, const QString &message) {
+        progressDialog->deleteLater();
+        restoreThread->wait();
+        restoreThread->deleteLater();
+        restoreThread = nullptr;
+
+        if (canceled) return;
+        if (!success) {
+            QMessageBox::warning(this, "恢复失败", message);
+            return;
+        }
 
-        if (Database::instance().restoreDatabase(fileName)) {
-            QMessageBox::information(this, "成功", "数据恢复成功！程序将重启以应用更改。");
-            qApp->quit();
-            QProcess::startDetached(qApp->arguments()[0], qApp->arguments());
-        } else {
-            QMessageBox::warning(this, "失败", "恢复失败，可能是文件损坏或被占用。");
-            if(remindThread) remindThread->start();
+        // 校验通过后原子替换，模型和后台线程随 databaseReplaced 就地重新加载
+        switch (Database::instance().replaceDatabase(stagedPath)) {
+        case Database::ReplaceOk:
+            updateStatusBar("数据已从备份恢复");
+            QMessageBox::information(this, "成功", "数据恢复成功！");
+            break;
+        case Database::ReplaceFileFailed:
+            QFile::remove(stagedPath);
+            QMessageBox::warning(this, "失败", "恢复失败，数据库文件可能被其他程序占用，当前数据未改动。");
+            break;
+        case Database::ReplaceOpenFailed:
+            QMessageBox::critical(this, "失败", "备份数据已换入，但重新打开数据库失败，请重启程序。");
+            break;
         }
-    }
+    });
+    restoreThread->start();
 }
 
 void MainWindow::onAddCategory()
@@ -1400,19 +1705,73 @@ void MainWindow::loadUserPreferences()
     }
 }
 
-void MainWindow::closeEvent(QCloseEvent *event)
+void MainWindow::reloadSettings()
 {
-    if (Database::instance().getSetting("auto_purge_bin", "false") == "true") {
-        QSqlQuery q(Database::instance().getDatabase());
-        q.exec("DELETE FROM tasks WHERE is_deleted = 1");
-        q.exec("DELETE FROM inspirations WHERE is_deleted = 1");
-        qDebug() << "已自动清空回收站";
+    Database &database = Database::instance();
+    updateThemeColor();
+
+    // 只刷新控件显示，不触发写回数据库的槽
+    auto setCombo = [](QComboBox *combo, int index) {
+        if (!combo || index < 0) return;
+        combo->blockSignals(true);
+        combo->setCurrentIndex(index);
+        combo->blockSignals(false);
+    };
+    auto setCheck = [](QCheckBox *check, bool checked) {
+        if (!check) return;
+        check->blockSignals(true);
+        check->setChecked(checked);
+        check->blockSignals(false);
+    };
+
+    setCombo(defaultViewCombo, database.getSetting("default_view", "0").toInt());
+    if (bgModeCombo) setCombo(bgModeCombo, bgModeCombo->findData(database.getSetting("bg_mode", "dark")));
+    if (themeColorCombo) setCombo(themeColorCombo, themeColorCombo->findData(database.getSetting("theme_color", "#657896")));
+    setCombo(startDayCombo, database.getSetting("calendar_start_day", "1").toInt() == 7 ? 1 : 0);
+    if (defaultRemindCombo) {
+        setCombo(defaultRemindCombo, defaultRemindCombo->findData(database.getSetting("default_remind_minutes", "60").toInt()));
     }
 
+    setCheck(soundCheck, database.getSetting("sound_enabled", "true") == "true");
+    setCheck(popupCheck, database.getSetting("popup_enabled", "true") == "true");
+    setCheck(autoPurgeCheck, database.getSetting("auto_purge_bin", "false") == "true");
+    setCheck(autoBackupCheck, database.getSetting("auto_backup_enabled", "false") == "true");
+    // 查询分析的开关和阈值已由 initDatabase 按新数据库设置
+    setCheck(profilerCheck, QueryProfiler::instance().isEnabled());
+    if (autoPurgeCheck) {
+        autoPurgeCheck->setText(QString("自动清理回收站中超过 %1 天的项目").arg(database.getSetting("auto_purge_days", "30")));
+    }
+    if (profilerCheck) {
+        profilerCheck->setToolTip(QString("超过 %1 ms 的查询连同执行计划写入 %2")
+                                      .arg(database.getSetting("slow_query_threshold_ms", "100"),
+                                           QDir::toNativeSeparators(QueryProfiler::instance().logPath())));
+    }
+
+    loadUserPreferences();
+}
+
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    // 回收站清理由 PurgeThread 在后台完成，退出时只需停下后台线程
     if (remindThread) {
         remindThread->stop();
         remindThread->wait();
     }
 
+    if (backupThread) {
+        backupThread->stop();
+        backupThread->wait();
+    }
+
+    if (purgeThread) {
+        purgeThread->stop();
+        purgeThread->wait();
+    }
+
+    if (archiveThread) {
+        archiveThread->stop();
+        archiveThread->wait();
+    }
+
     QMainWindow::closeEvent(event);
 }
@@ -61,6 +61,10 @@ private slots:
 
     void onBackupDatabase();
     void onRestoreDatabase();
+    void onImportTasks();
+    void onRebuildStatistics();
+    void onArchiveTasks();
+    void onShowQueryStats();
     void onAddCategory();
     void onDeleteCategory();
     void onTaskReminded(int taskId, const QString &title);
@@ -98,6 +102,11 @@ private:
     TaskFilterModel *completedProxyModel;
 
     RemindThread *remindThread;
+    class ImportThread *importThread;
+    class BackupThread *backupThread;
+    class RestoreThread *restoreThread;
+    class PurgeThread *purgeThread;
+    class ArchiveThread *archiveThread;
     QListWidget *settingCategoryList;
     QLineEdit *settingCategoryEdit;
     QComboBox *defaultViewCombo;
@@ -106,10 +115,16 @@ private:
     QComboBox *startDayCombo;
     QComboBox *defaultRemindCombo;
     QCheckBox *autoPurgeCheck;
+    QCheckBox *soundCheck;
+    QCheckBox *popupCheck;
+    QCheckBox *autoBackupCheck;
+    QCheckBox *profilerCheck;
 
     QWidget *categoryContainer;
     QPushButton *categoryToggleBtn;
 
+    QString appliedStyleVariant;
+
     void setupSystemTray();
     void setupUI();
     void createWatermark();
@@ -121,6 +136,12 @@ private:
     void createStatisticTab();
     void createSettingTab();
     void loadUserPreferences();
+    // 恢复备份后按新数据库的设置刷新主题和设置页控件
+    void reloadSettings();
+    void startRemindThread();
+    void startBackupThread();
+    void startPurgeThread();
+    void startArchiveThread();
     void updateThemeColor();
 
     void updateStatusBar(const QString &message);
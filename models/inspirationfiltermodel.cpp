@@ -0,0 +1,135 @@
+#include "inspirationfiltermodel.h"
+
+InspirationFilterModel::InspirationFilterModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_source(nullptr)
+    , m_matchAll(false)
+    , m_useMonth(false)
+    , m_yearMonth(0)
+    , m_cacheValid(false)
+    , m_narrowing(false)
+{
+    setDynamicSortFilter(true);
+}
+
+void InspirationFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (m_source) {
+        disconnect(m_source, nullptr, this, nullptr);
+    }
+
+    m_source = qobject_cast<InspirationModel*>(sourceModel);
+    invalidateCache();
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+
+    if (m_source) {
+        connect(m_source, &QAbstractItemModel::modelAboutToBeReset, this, &InspirationFilterModel::invalidateCache);
+        connect(m_source, &QAbstractItemModel::rowsAboutToBeInserted, this, &InspirationFilterModel::invalidateCache);
+        connect(m_source, &QAbstractItemModel::rowsAboutToBeRemoved, this, &InspirationFilterModel::invalidateCache);
+        connect(m_source, &QAbstractItemModel::dataChanged, this, &InspirationFilterModel::invalidateCache);
+    }
+}
+
+void InspirationFilterModel::setSearchText(const QString &text)
+{
+    QString folded = text.toCaseFolded();
+    if (folded == m_searchText) return;
+
+    // 新关键词包含旧关键词时，结果只会是上次结果的子集
+    bool narrowing = !m_searchText.isEmpty() && folded.contains(m_searchText);
+    m_searchText = folded;
+    refilter(narrowing);
+}
+
+void InspirationFilterModel::setTagFilter(const QStringList &tags, bool matchAll)
+{
+    QStringList trimmedTags;
+    QStringList folded;
+    for (const QString &t : tags) {
+        QString trimmed = t.trimmed();
+        if (trimmed.isEmpty()) continue;
+        trimmedTags.append(trimmed);
+        folded.append(trimmed.toCaseFolded());
+    }
+    if (trimmedTags == m_tags && matchAll == m_matchAll) return;
+
+    m_tags = trimmedTags;
+    m_foldedTags = folded;
+    m_matchAll = matchAll;
+    refilter(false);
+}
+
+void InspirationFilterModel::setMonthFilter(bool enabled, int year, int month)
+{
+    int yearMonth = year * 100 + month;
+    if (enabled == m_useMonth && (!enabled || yearMonth == m_yearMonth)) return;
+
+    m_useMonth = enabled;
+    m_yearMonth = yearMonth;
+    refilter(false);
+}
+
+void InspirationFilterModel::refilter(bool narrowing)
+{
+    m_narrowing = narrowing && m_cacheValid;
+    invalidateFilter();
+    m_narrowing = false;
+    m_cacheValid = true;
+}
+
+void InspirationFilterModel::invalidateCache()
+{
+    m_cacheValid = false;
+    m_acceptCache.clear();
+}
+
+bool InspirationFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+    Q_UNUSED(source_parent);
+    if (!m_source || source_row >= m_source->rowCount()) return false;
+
+    if (m_narrowing && source_row < m_acceptCache.size() && !m_acceptCache.at(source_row)) {
+        return false;
+    }
+
+    bool accepted = matches(m_source->itemAt(source_row));
+
+    if (m_acceptCache.size() != m_source->rowCount()) {
+        m_acceptCache.fill(false, m_source->rowCount());
+    }
+    m_acceptCache[source_row] = accepted;
+
+    return accepted;
+}
+
+bool InspirationFilterModel::matches(const InspirationModel::InspirationItem &item) const
+{
+    if (m_useMonth && item.createdYearMonth != m_yearMonth) {
+        return false;
+    }
+
+    // 与原先的筛选一致：全部匹配不区分大小写，任一匹配要求标签完全相同
+    if (!m_tags.isEmpty()) {
+        if (m_matchAll) {
+            if (item.foldedTagList.size() != m_foldedTags.size()) return false;
+            for (const QString &tag : m_foldedTags) {
+                if (!item.foldedTagList.contains(tag)) return false;
+            }
+        } else {
+            bool anyMatch = false;
+            for (const QString &tag : m_tags) {
+                if (item.trimmedTagList.contains(tag)) {
+                    anyMatch = true;
+                    break;
+                }
+            }
+            if (!anyMatch) return false;
+        }
+    }
+
+    if (!m_searchText.isEmpty()) {
+        return item.foldedContent.contains(m_searchText) || item.foldedTags.contains(m_searchText);
+    }
+
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef INSPIRATIONFILTERMODEL_H
+#define INSPIRATIONFILTERMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QVector>
+#include "inspirationmodel.h"
+
+class InspirationFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit InspirationFilterModel(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    void setSearchText(const QString &text);
+    void setTagFilter(const QStringList &tags, bool matchAll);
+    void setMonthFilter(bool enabled, int year, int month);
+
+protected:
+    bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+
+private:
+    InspirationModel *m_source;
+
+    QString m_searchText;
+    QStringList m_tags;
+    QStringList m_foldedTags;
+    bool m_matchAll;
+    bool m_useMonth;
+    int m_yearMonth;
+
+    // 上一次过滤的结果，搜索词只是变长时只需复查上次通过的行
+    mutable QVector<bool> m_acceptCache;
+    bool m_cacheValid;
+    bool m_narrowing;
+
+    bool matches(const InspirationModel::InspirationItem &item) const;
+    void refilter(bool narrowing);
+    void invalidateCache();
+};
+
+#endif // INSPIRATIONFILTERMODEL_H
@@ -1,5 +1,6 @@
 #include "inspirationmodel.h"
 #include "database/database.h"
+#include "database/queryprofiler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
@@ -10,6 +11,15 @@ InspirationModel::InspirationModel(QObject *parent)
 {
     db = Database::instance().getDatabase();
     refresh();
+
+    // 恢复备份时先放开旧连接，换入新数据库后重新取得连接并重新加载
+    connect(&Database::instance(), &Database::aboutToReplaceDatabase, this, [this](){
+        db = QSqlDatabase();
+    });
+    connect(&Database::instance(), &Database::databaseReplaced, this, [this](){
+        db = Database::instance().getDatabase();
+        refresh();
+    });
 }
 
 InspirationModel::~InspirationModel()
@@ -47,6 +57,13 @@ QVariant InspirationModel::data(const QModelIndex &index, int role) const
     case Qt::UserRole:
         return item.toVariantMap();
 
+    case IdRole: return item.id;
+    case ContentRole: return item.content;
+    case TagsRole: return item.tags;
+    case TagListRole: return item.tagList();
+    case CreatedAtRole: return item.createdAt;
+    case UpdatedAtRole: return item.updatedAt;
+
     case Qt::ToolTipRole:
         return QString("完整内容:\n%1\n\n标签: %2")
             .arg(item.content)
@@ -94,7 +111,7 @@ void InspirationModel::loadInspirations()
     QSqlQuery query(db);
     query.prepare("SELECT * FROM inspirations WHERE is_deleted = 0 ORDER BY created_at DESC");
 
-    if (!query.exec()) {
+    if (!QueryProfiler::exec(query, "InspirationModel")) {
         qDebug() << "加载灵感记录失败:" << query.lastError().text();
         endResetModel();
         return;
@@ -107,6 +124,7 @@ void InspirationModel::loadInspirations()
         item.tags = query.value("tags").toString();
         item.createdAt = query.value("created_at").toDateTime();
         item.updatedAt = query.value("updated_at").toDateTime();
+        item.buildSearchKeys();
 
         inspirations.append(item);
     }
@@ -126,13 +144,14 @@ bool InspirationModel::addInspiration(const QString &content, const QString &tag
     query.addBindValue(now);
     query.addBindValue(now);
 
-    if (!query.exec()) {
+    if (!QueryProfiler::exec(query, "InspirationModel")) {
         qDebug() << "添加灵感记录失败:" << query.lastError().text();
         return false;
     }
 
     int newId = query.lastInsertId().toInt();
 
+    Database::instance().markDataChanged();
     refresh();
     emit inspirationAdded(newId);
 
@@ -149,11 +168,12 @@ bool InspirationModel::updateInspiration(int id, const QString &content, const Q
     query.addBindValue(getCurrentTimestamp());
     query.addBindValue(id);
 
-    if (!query.exec()) {
+    if (!QueryProfiler::exec(query, "InspirationModel")) {
         qDebug() << "更新灵感记录失败:" << query.lastError().text();
         return false;
     }
 
+    Database::instance().markDataChanged();
     refresh();
     emit inspirationUpdated(id);
 
@@ -168,11 +188,12 @@ bool InspirationModel::deleteInspiration(int id)
     query.addBindValue(getCurrentTimestamp());
     query.addBindValue(id);
 
-    if (!query.exec()) {
+    if (!QueryProfiler::exec(query, "InspirationModel")) {
         qDebug() << "删除灵感记录失败:" << query.lastError().text();
         return false;
     }
 
+    Database::instance().markDataChanged();
     refresh();
     emit inspirationDeleted(id);
     return true;
@@ -189,7 +210,7 @@ bool InspirationModel::deleteInspirations(const QList<int> &ids)
 
     for (int id : ids) {
         query.addBindValue(id);
-        if (!query.exec()) {
+        if (!QueryProfiler::exec(query, "InspirationModel")) {
             qDebug() << "批量删除灵感记录失败:" << query.lastError().text();
             db.rollback();
             return false;
@@ -198,6 +219,7 @@ bool InspirationModel::deleteInspirations(const QList<int> &ids)
 
     db.commit();
 
+    Database::instance().markDataChanged();
     refresh();
 
     return true;
@@ -210,7 +232,7 @@ QList<QVariantMap> InspirationModel::getAllInspirations() const
     QSqlQuery query(db);
     query.prepare("SELECT * FROM inspirations WHERE is_deleted = 0 ORDER BY created_at DESC");
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QVariantMap item;
             item["id"] = query.value("id").toInt();
@@ -235,7 +257,7 @@ QList<QVariantMap> InspirationModel::getInspirationsByDate(const QDate &date) co
                   "ORDER BY created_at DESC");
     query.addBindValue(date.toString("yyyy-MM-dd"));
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QVariantMap item;
             item["id"] = query.value("id").toInt();
@@ -260,7 +282,7 @@ QList<QVariantMap> InspirationModel::getInspirationsByTag(const QString &tag) co
                   "ORDER BY created_at DESC");
     query.addBindValue("%" + tag + "%");
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QVariantMap item;
             item["id"] = query.value("id").toInt();
@@ -291,7 +313,7 @@ QList<QVariantMap> InspirationModel::searchInspirations(const QString &keyword)
     query.addBindValue(searchPattern);
     query.addBindValue(searchPattern);
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QVariantMap item;
             item["id"] = query.value("id").toInt();
@@ -311,7 +333,7 @@ int InspirationModel::getInspirationCount() const
     QSqlQuery query(db);
     query.prepare("SELECT COUNT(*) FROM inspirations");
 
-    if (query.exec() && query.next()) {
+    if (QueryProfiler::exec(query, "InspirationModel") && query.next()) {
         return query.value(0).toInt();
     }
 
@@ -325,7 +347,7 @@ QList<QDate> InspirationModel::getDatesWithInspirations() const
     QSqlQuery query(db);
     query.prepare("SELECT DISTINCT DATE(created_at) as date FROM inspirations WHERE is_deleted = 0 ORDER BY date DESC");
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             dates.append(query.value("date").toDate());
         }
@@ -381,7 +403,7 @@ QStringList InspirationModel::getAllTags() const
     QSqlQuery query(db);
     query.prepare("SELECT tags FROM inspirations WHERE tags IS NOT NULL AND tags != ''");
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QString tags = query.value("tags").toString();
             QStringList tagList = tags.split(",", Qt::SkipEmptyParts);
@@ -412,7 +434,8 @@ bool InspirationModel::restoreInspiration(int id)
     QSqlQuery query(db);
     query.prepare("UPDATE inspirations SET is_deleted = 0 WHERE id = ?");
     query.addBindValue(id);
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
+        Database::instance().markDataChanged();
         refresh();
         return true;
     }
@@ -424,7 +447,9 @@ bool InspirationModel::permanentDeleteInspiration(int id)
     QSqlQuery query(db);
     query.prepare("DELETE FROM inspirations WHERE id = ?");
     query.addBindValue(id);
-    return query.exec();
+    if (!QueryProfiler::exec(query, "InspirationModel")) return false;
+    Database::instance().markDataChanged();
+    return true;
 }
 
 QList<QVariantMap> InspirationModel::getDeletedInspirations() const
@@ -432,7 +457,7 @@ QList<QVariantMap> InspirationModel::getDeletedInspirations() const
     QList<QVariantMap> result;
     QSqlQuery query(db);
     query.prepare("SELECT * FROM inspirations WHERE is_deleted = 1 ORDER BY updated_at DESC");
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "InspirationModel")) {
         while (query.next()) {
             QVariantMap item;
             item["id"] = query.value("id");
@@ -449,7 +474,9 @@ QList<QVariantMap> InspirationModel::getDeletedInspirations() const
 bool InspirationModel::emptyRecycleBin()
 {
     QSqlQuery query(db);
-    return query.exec("DELETE FROM inspirations WHERE is_deleted = 1");
+    if (!QueryProfiler::exec(query, "DELETE FROM inspirations WHERE is_deleted = 1", "InspirationModel")) return false;
+    Database::instance().markDataChanged();
+    return true;
 }
 
 static QString updateTagString(const QString &tags, const QString &oldTag, const QString &newTag = QString())
@@ -482,7 +509,7 @@ bool InspirationModel::renameTag(const QString &oldName, const QString &newName)
     query.prepare("SELECT id, tags FROM inspirations WHERE tags LIKE ?");
     query.addBindValue("%" + oldName + "%");
 
-    if (!query.exec()) return false;
+    if (!QueryProfiler::exec(query, "InspirationModel")) return false;
 
     db.transaction();
     while (query.next()) {
@@ -495,7 +522,7 @@ bool InspirationModel::renameTag(const QString &oldName, const QString &newName)
             updateQuery.prepare("UPDATE inspirations SET tags = ? WHERE id = ?");
             updateQuery.addBindValue(newTags);
             updateQuery.addBindValue(id);
-            updateQuery.exec();
+            QueryProfiler::exec(updateQuery, "InspirationModel");
         }
     }
     db.commit();
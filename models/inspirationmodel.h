@@ -11,6 +11,67 @@ class InspirationModel : public QAbstractTableModel
     Q_OBJECT
 
 public:
+    enum InspirationRole {
+        IdRole = Qt::UserRole + 1,
+        ContentRole,
+        TagsRole,
+        TagListRole,
+        CreatedAtRole,
+        UpdatedAtRole
+    };
+
+    struct InspirationItem {
+        int id;
+        QString content;
+        QString tags;
+        QDateTime createdAt;
+        QDateTime updatedAt;
+
+        // 搜索用的预处理字段，加载时计算一次
+        QString foldedContent;
+        QString foldedTags;
+        QStringList foldedTagList;
+        QStringList trimmedTagList;   // 保留大小写，标签“任一匹配”按原样比较
+        int createdYearMonth = 0;
+
+        void buildSearchKeys() {
+            foldedContent = content.toCaseFolded();
+            foldedTags = tags.toCaseFolded();
+            foldedTagList.clear();
+            trimmedTagList.clear();
+            for (const QString &t : tags.split(",", Qt::SkipEmptyParts)) {
+                QString trimmed = t.trimmed();
+                if (trimmed.isEmpty()) continue;
+                trimmedTagList.append(trimmed);
+                foldedTagList.append(trimmed.toCaseFolded());
+            }
+            QDate d = createdAt.date();
+            createdYearMonth = d.isValid() ? d.year() * 100 + d.month() : 0;
+        }
+
+        QVariantMap toVariantMap() const {
+            QVariantMap map;
+            map["id"] = id;
+            map["content"] = content;
+            map["tags"] = tags;
+            map["created_at"] = createdAt;
+            map["updated_at"] = updatedAt;
+            return map;
+        }
+
+        QString preview(int maxLength = 50) const {
+            if (content.length() <= maxLength) {
+                return content;
+            }
+            return content.left(maxLength) + "...";
+        }
+
+        QStringList tagList() const {
+            if (tags.isEmpty()) return QStringList();
+            return tags.split(",", Qt::SkipEmptyParts);
+        }
+    };
+
     explicit InspirationModel(QObject *parent = nullptr);
     ~InspirationModel();
 
@@ -20,6 +81,8 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
+    const InspirationItem &itemAt(int row) const { return inspirations.at(row); }
+
     bool addInspiration(const QString &content, const QString &tags = "");
     bool updateInspiration(int id, const QString &content, const QString &tags = "");
     bool deleteInspiration(int id);
@@ -51,36 +114,6 @@ signals:
     void inspirationDeleted(int id);
 
 private:
-    struct InspirationItem {
-        int id;
-        QString content;
-        QString tags;
-        QDateTime createdAt;
-        QDateTime updatedAt;
-
-        QVariantMap toVariantMap() const {
-            QVariantMap map;
-            map["id"] = id;
-            map["content"] = content;
-            map["tags"] = tags;
-            map["created_at"] = createdAt;
-            map["updated_at"] = updatedAt;
-            return map;
-        }
-
-        QString preview(int maxLength = 50) const {
-            if (content.length() <= maxLength) {
-                return content;
-            }
-            return content.left(maxLength) + "...";
-        }
-
-        QStringList tagList() const {
-            if (tags.isEmpty()) return QStringList();
-            return tags.split(",", Qt::SkipEmptyParts);
-        }
-    };
-
     QList<InspirationItem> inspirations;
     QSqlDatabase db;
 
@@ -1,11 +1,34 @@
 #include "statisticmodel.h"
 #include "database/database.h"
+#include "database/queryprofiler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
 #include <QDebug>
+#include <algorithm>
 
-StatisticModel::StatisticModel(QObject *parent) : QObject(parent) {}
+StatisticModel::StatisticModel(QObject *parent) : QObject(parent), m_cache(32) {}
+
+void StatisticModel::setConnectionName(const QString &connectionName)
+{
+    m_connectionName = connectionName;
+}
+
+QSqlDatabase StatisticModel::database() const
+{
+    if (m_connectionName.isEmpty()) return QSqlDatabase::database();
+    return QSqlDatabase::database(m_connectionName);
+}
+
+QString StatisticModel::taskSource(const Filter &f)
+{
+    return f.includeArchive ? "all_tasks" : "tasks";
+}
+
+QString StatisticModel::tagRelationSource(const Filter &f)
+{
+    return f.includeArchive ? "all_task_tag_relations" : "task_tag_relations";
+}
 
 QString StatisticModel::buildCategoryInClause(const QList<int> &ids) const
 {
@@ -22,11 +45,11 @@ QVariantMap StatisticModel::getOverviewStats(const Filter &f) const
     QString timeClause = " AND deadline BETWEEN ? AND ? ";
 
     auto getCount = [&](const QString &extra) {
-        QSqlQuery q;
-        q.prepare("SELECT COUNT(*) FROM tasks WHERE is_deleted = 0 " + timeClause + catClause + extra);
+        QSqlQuery q(database());
+        q.prepare("SELECT COUNT(*) FROM " + taskSource(f) + " WHERE is_deleted = 0 " + timeClause + catClause + extra);
         q.addBindValue(f.start);
         q.addBindValue(f.end);
-        if (q.exec() && q.next()) return q.value(0).toInt();
+        if (QueryProfiler::exec(q, "StatisticModel") && q.next()) return q.value(0).toInt();
         return 0;
     };
 
@@ -40,17 +63,237 @@ QVariantMap StatisticModel::getOverviewStats(const Filter &f) const
     return res;
 }
 
+StatisticModel::Snapshot StatisticModel::computeSnapshot(const Filter &f, TrendGranularity granularity) const
+{
+    Snapshot snap;
+    if (lookupCache(f, granularity, snap)) return snap;
+
+    // 先记下版本号，计算期间发生的写入会让这份结果在下次查找时失效
+    quint64 version = Database::instance().dataVersion();
+    bool ok = fillOverview(f, snap);
+    ok = fillTrend(f, granularity, snap) && ok;
+    ok = fillDurations(f, snap) && ok;
+    ok = fillHeatmaps(f, snap) && ok;
+    if (ok) storeCache(f, granularity, snap, version);
+    return snap;
+}
+
+QString StatisticModel::cacheKey(const Filter &f, TrendGranularity granularity)
+{
+    QList<int> ids = f.categoryIds;
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    QStringList strIds;
+    for (int id : ids) strIds << QString::number(id);
+
+    // 逾期判断和趋势截断依赖当天日期，跨天后自然换 key
+    return QString("%1|%2|%3|%4|%5|%6")
+        .arg(f.start.toString(Qt::ISODateWithMs),
+             f.end.toString(Qt::ISODateWithMs),
+             strIds.join(","),
+             QString::number(granularity),
+             QDate::currentDate().toString(Qt::ISODate),
+             QString(f.includeArchive ? "a" : ""));
+}
+
+bool StatisticModel::lookupCache(const Filter &f, TrendGranularity granularity, Snapshot &snap) const
+{
+    QString key = cacheKey(f, granularity);
+    CacheEntry *entry = m_cache.object(key);
+    if (!entry) return false;
+
+    if (entry->version != Database::instance().dataVersion()) {
+        m_cache.remove(key);
+        return false;
+    }
+
+    snap = entry->snapshot;
+    return true;
+}
+
+void StatisticModel::storeCache(const Filter &f, TrendGranularity granularity, const Snapshot &snap, quint64 version) const
+{
+    m_cache.insert(cacheKey(f, granularity), new CacheEntry{version, snap});
+}
+
+bool StatisticModel::fillOverview(const Filter &f, Snapshot &snap) const
+{
+    QStringList priorityNames = {"紧急", "重要", "普通", "不急"};
+    QStringList statusNames = {"待办", "进行中", "已完成", "已延期"};
+    for (const QString &name : priorityNames) snap.byPriority[name] = 0;
+
+    QString catClause = buildCategoryInClause(f.categoryIds);
+
+    // 截止日期落在区间内的任务：一次分组扫描得到概览和各维度分布
+    QSqlQuery q(database());
+    q.prepare("SELECT c.name, t.priority, t.status, "
+              "CASE WHEN t.status != 2 AND t.deadline < datetime('now','localtime') THEN 1 ELSE 0 END AS is_overdue, "
+              "COUNT(*) "
+              "FROM " + taskSource(f) + " t LEFT JOIN task_categories c ON t.category_id = c.id "
+              "WHERE t.is_deleted = 0 AND t.deadline BETWEEN ? AND ? " + catClause +
+              "GROUP BY c.name, t.priority, t.status, is_overdue");
+    q.addBindValue(f.start);
+    q.addBindValue(f.end);
+
+    if (!QueryProfiler::exec(q, "StatisticModel")) {
+        qDebug() << "统计快照查询失败:" << q.lastError().text();
+        return false;
+    }
+
+    while (q.next()) {
+        int priority = q.value(1).toInt();
+        int status = q.value(2).toInt();
+        int count = q.value(4).toInt();
+
+        snap.total += count;
+        if (status == 2) snap.completed += count;
+        if (q.value(3).toInt() == 1) snap.overdue += count;
+
+        if (!q.value(0).isNull()) snap.byCategory[q.value(0).toString()] += count;
+        if (priority >= 0 && priority < priorityNames.size()) snap.byPriority[priorityNames[priority]] += count;
+        snap.byStatus[statusNames.value(status, "未知")] += count;
+    }
+
+    snap.rate = snap.total > 0 ? (double)snap.completed / snap.total * 100.0 : 0.0;
+    snap.inspirationCount = getInspirationCount(f);
+
+    return true;
+}
+
+bool StatisticModel::fillTrend(const Filter &f, TrendGranularity granularity, Snapshot &snap) const
+{
+    // 完成趋势和平均耗时来自每日汇总表
+    QDate startDate = f.start.date();
+    QDate endDate = f.end.date();
+    QDate trendStart = startDate;
+    QDate trendEnd = endDate;
+    if (granularity == TrendMonthly) {
+        trendStart = QDate(startDate.year(), 1, 1);
+        trendEnd = QDate(startDate.year(), 12, 31);
+        snap.trend.fill(0, 12);
+    } else {
+        snap.trend.fill(0, qMax(startDate.daysTo(endDate) + 1, (qint64)0));
+    }
+
+    QSqlQuery r(database());
+    r.prepare("SELECT day, SUM(task_count), SUM(duration_hours_sum), SUM(duration_count) "
+              "FROM task_daily_rollup WHERE status = 2 AND day BETWEEN ? AND ? "
+              + buildCategoryInClause(f.categoryIds) +
+              "GROUP BY day");
+    r.addBindValue(qMin(startDate, trendStart).toString("yyyy-MM-dd"));
+    r.addBindValue(qMax(endDate, trendEnd).toString("yyyy-MM-dd"));
+
+    if (!QueryProfiler::exec(r, "StatisticModel")) {
+        qDebug() << "统计汇总查询失败:" << r.lastError().text();
+        return false;
+    }
+
+    double durationSum = 0.0;
+    int durationCount = 0;
+    QDate today = QDate::currentDate();
+
+    while (r.next()) {
+        QDate d = QDate::fromString(r.value(0).toString(), "yyyy-MM-dd");
+        int count = r.value(1).toInt();
+
+        if (d >= trendStart && d <= trendEnd) {
+            int idx = granularity == TrendMonthly ? d.month() - 1 : (d <= today ? startDate.daysTo(d) : -1);
+            if (idx >= 0 && idx < snap.trend.size()) snap.trend[idx] += count;
+        }
+        if (d >= startDate && d <= endDate) {
+            durationSum += r.value(2).toDouble();
+            durationCount += r.value(3).toInt();
+        }
+    }
+
+    snap.avgCompletionHours = durationCount > 0 ? durationSum / durationCount : 0.0;
+    return true;
+}
+
+bool StatisticModel::fillDurations(const Filter &f, Snapshot &snap) const
+{
+    QStringList priorityNames = {"紧急", "重要", "普通", "不急"};
+
+    // 按完成日期落在区间内的草图逐桶相加即为该区间的分布，不需要取原始耗时排序
+    QSqlQuery q(database());
+    q.prepare("SELECT s.metric, c.name, s.priority, s.bucket, SUM(s.sample_count) "
+              "FROM task_duration_sketch s LEFT JOIN task_categories c ON s.category_id = c.id "
+              "WHERE s.day BETWEEN ? AND ? " + buildCategoryInClause(f.categoryIds) +
+              "GROUP BY s.metric, s.category_id, s.priority, s.bucket");
+    q.addBindValue(f.start.date().toString("yyyy-MM-dd"));
+    q.addBindValue(f.end.date().toString("yyyy-MM-dd"));
+
+    if (!QueryProfiler::exec(q, "StatisticModel")) {
+        qDebug() << "耗时分布查询失败:" << q.lastError().text();
+        return false;
+    }
+
+    while (q.next()) {
+        DurationBreakdown &target = q.value(0).toInt() == 0 ? snap.leadTime : snap.completionTime;
+        int priority = q.value(2).toInt();
+        int bucket = q.value(3).toInt();
+        qint64 count = q.value(4).toLongLong();
+
+        target.overall.add(bucket, count);
+        if (!q.value(1).isNull()) target.byCategory[q.value(1).toString()].add(bucket, count);
+        if (priority >= 0 && priority < priorityNames.size()) target.byPriority[priorityNames[priority]].add(bucket, count);
+    }
+    return true;
+}
+
+bool StatisticModel::fillHeatmaps(const Filter &f, Snapshot &snap) const
+{
+    // 年度热力图为截止到结束日期所在周的最近 53 周
+    QDate endDate = f.end.date();
+    QDate gridStart = endDate.addDays(1 - endDate.dayOfWeek()).addDays(-7 * 52);
+    QDate queryStart = qMin(gridStart, f.start.date());
+
+    snap.yearHeatmapStart = gridStart;
+    snap.yearHeatmap.fill(0, 53 * 7);
+    snap.weekHourHeatmap.fill(0, 7 * 24);
+
+    // 一次按 日期 × 小时 聚合，同时得到两张热力图
+    QSqlQuery q(database());
+    q.prepare("SELECT date(completed_at) AS d, CAST(strftime('%H', completed_at) AS INTEGER) AS h, COUNT(*) "
+              "FROM " + taskSource(f) + " WHERE is_deleted = 0 AND status = 2 AND completed_at >= ? AND completed_at < ? "
+              + buildCategoryInClause(f.categoryIds) + "GROUP BY d, h");
+    q.addBindValue(QDateTime(queryStart, QTime(0, 0, 0)));
+    q.addBindValue(QDateTime(endDate.addDays(1), QTime(0, 0, 0)));
+
+    if (!QueryProfiler::exec(q, "StatisticModel")) {
+        qDebug() << "热力图查询失败:" << q.lastError().text();
+        return false;
+    }
+
+    QDate rangeStart = f.start.date();
+    while (q.next()) {
+        QDate d = QDate::fromString(q.value(0).toString(), "yyyy-MM-dd");
+        int hour = q.value(1).toInt();
+        int count = q.value(2).toInt();
+        if (!d.isValid()) continue;
+
+        int dayIndex = gridStart.daysTo(d);
+        if (dayIndex >= 0 && dayIndex < snap.yearHeatmap.size()) snap.yearHeatmap[dayIndex] += count;
+
+        if (d >= rangeStart && d <= endDate && hour >= 0 && hour < 24) {
+            snap.weekHourHeatmap[(d.dayOfWeek() - 1) * 24 + hour] += count;
+        }
+    }
+    return true;
+}
+
 QMap<QString, int> StatisticModel::getTasksCountByCategory(const Filter &f) const
 {
     QMap<QString, int> result;
-    QSqlQuery q;
-    q.prepare("SELECT c.name, COUNT(t.id) as cnt FROM tasks t "
+    QSqlQuery q(database());
+    q.prepare("SELECT c.name, COUNT(t.id) as cnt FROM " + taskSource(f) + " t "
               "JOIN task_categories c ON t.category_id = c.id "
               "WHERE t.is_deleted = 0 AND t.deadline BETWEEN ? AND ? "
               + buildCategoryInClause(f.categoryIds) + " GROUP BY c.name");
     q.addBindValue(f.start);
     q.addBindValue(f.end);
-    if (q.exec()) while (q.next()) result[q.value(0).toString()] = q.value(1).toInt();
+    if (QueryProfiler::exec(q, "StatisticModel")) while (q.next()) result[q.value(0).toString()] = q.value(1).toInt();
     return result;
 }
 
@@ -60,12 +303,12 @@ QMap<QString, int> StatisticModel::getTasksCountByPriority(const Filter &f) cons
     result["紧急"] = 0; result["重要"] = 0; result["普通"] = 0; result["不急"] = 0;
 
     QStringList names = {"紧急", "重要", "普通", "不急"};
-    QSqlQuery q;
-    q.prepare("SELECT priority, COUNT(*) FROM tasks WHERE is_deleted = 0 AND deadline BETWEEN ? AND ? "
+    QSqlQuery q(database());
+    q.prepare("SELECT priority, COUNT(*) FROM " + taskSource(f) + " WHERE is_deleted = 0 AND deadline BETWEEN ? AND ? "
               + buildCategoryInClause(f.categoryIds) + " GROUP BY priority");
     q.addBindValue(f.start);
     q.addBindValue(f.end);
-    if (q.exec()) {
+    if (QueryProfiler::exec(q, "StatisticModel")) {
         while (q.next()) {
             int p = q.value(0).toInt();
             if (p >= 0 && p < names.size()) result[names[p]] = q.value(1).toInt();
@@ -78,12 +321,12 @@ QMap<QString, int> StatisticModel::getTasksCountByStatus(const Filter &f) const
 {
     QMap<QString, int> result;
     QStringList names = {"待办", "进行中", "已完成", "已延期"};
-    QSqlQuery q;
-    q.prepare("SELECT status, COUNT(*) FROM tasks WHERE is_deleted = 0 AND deadline BETWEEN ? AND ? "
+    QSqlQuery q(database());
+    q.prepare("SELECT status, COUNT(*) FROM " + taskSource(f) + " WHERE is_deleted = 0 AND deadline BETWEEN ? AND ? "
               + buildCategoryInClause(f.categoryIds) + " GROUP BY status");
     q.addBindValue(f.start);
     q.addBindValue(f.end);
-    if (q.exec()) while (q.next()) result[names.value(q.value(0).toInt(), "未知")] = q.value(1).toInt();
+    if (QueryProfiler::exec(q, "StatisticModel")) while (q.next()) result[names.value(q.value(0).toInt(), "未知")] = q.value(1).toInt();
     return result;
 }
 
@@ -91,12 +334,12 @@ QVector<int> StatisticModel::getHourlyTrend(const Filter &f) const
 {
     QVector<int> data(24, 0);
     int currentHour = QDateTime::currentDateTime().time().hour();
-    QSqlQuery q;
-    q.prepare("SELECT strftime('%H', completed_at) as hour, COUNT(*) FROM tasks "
+    QSqlQuery q(database());
+    q.prepare("SELECT strftime('%H', completed_at) as hour, COUNT(*) FROM " + taskSource(f) + " "
               "WHERE is_deleted = 0 AND status = 2 AND date(completed_at) = date(?) "
               + buildCategoryInClause(f.categoryIds) + " GROUP BY hour");
     q.addBindValue(f.start);
-    if (q.exec()) {
+    if (QueryProfiler::exec(q, "StatisticModel")) {
         while (q.next()) {
             int h = q.value(0).toInt();
             if (h >= 0 && h < 24) data[h] = q.value(1).toInt();
@@ -112,22 +355,19 @@ QVector<int> StatisticModel::getDailyTrend(const Filter &f) const
     if (days <= 0) return QVector<int>();
     QVector<int> data(days, 0);
     QDate today = QDate::currentDate();
-    QSqlQuery q;
-    q.prepare("SELECT date(completed_at) as d, COUNT(*) FROM tasks "
-              "WHERE is_deleted = 0 AND status = 2 AND completed_at BETWEEN ? AND ? "
-              + buildCategoryInClause(f.categoryIds) + " GROUP BY d");
-    q.addBindValue(f.start);
-    q.addBindValue(f.end);
-    if (q.exec()) {
+    QSqlQuery q(database());
+    q.prepare("SELECT day, SUM(task_count) FROM task_daily_rollup "
+              "WHERE status = 2 AND day BETWEEN ? AND ? "
+              + buildCategoryInClause(f.categoryIds) + " GROUP BY day");
+    q.addBindValue(f.start.date().toString("yyyy-MM-dd"));
+    q.addBindValue(f.end.date().toString("yyyy-MM-dd"));
+    if (QueryProfiler::exec(q, "StatisticModel")) {
         while (q.next()) {
             QDate d = QDate::fromString(q.value(0).toString(), "yyyy-MM-dd");
             int idx = f.start.date().daysTo(d);
-            if (idx >= 0 && idx < days) data[idx] = q.value(1).toInt();
+            if (idx >= 0 && idx < days && d <= today) data[idx] = q.value(1).toInt();
         }
     }
-    for(int i = 0; i < days; ++i) {
-        if (f.start.date().addDays(i) > today) data[i] = 0;
-    }
     return data;
 }
 
@@ -136,14 +376,14 @@ QVector<int> StatisticModel::getMonthlyTrend(const Filter &f) const
     QVector<int> data(12, 0);
     int year = f.start.date().year();
 
-    QSqlQuery q;
-    q.prepare("SELECT strftime('%m', completed_at) as m, COUNT(*) FROM tasks "
-              "WHERE is_deleted = 0 AND status = 2 "
-              "AND strftime('%Y', completed_at) = ? "
+    QSqlQuery q(database());
+    q.prepare("SELECT CAST(substr(day, 6, 2) AS INTEGER) AS m, SUM(task_count) FROM task_daily_rollup "
+              "WHERE status = 2 AND day BETWEEN ? AND ? "
               + buildCategoryInClause(f.categoryIds) + " GROUP BY m");
-    q.addBindValue(QString::number(year));
+    q.addBindValue(QDate(year, 1, 1).toString("yyyy-MM-dd"));
+    q.addBindValue(QDate(year, 12, 31).toString("yyyy-MM-dd"));
 
-    if (q.exec()) {
+    if (QueryProfiler::exec(q, "StatisticModel")) {
         while (q.next()) {
             int m = q.value(0).toInt();
             if (m >= 1 && m <= 12) {
@@ -156,22 +396,24 @@ QVector<int> StatisticModel::getMonthlyTrend(const Filter &f) const
 
 double StatisticModel::getAverageCompletionTime(const Filter &f) const
 {
-    QSqlQuery q;
-    q.prepare("SELECT AVG((julianday(completed_at) - julianday(created_at)) * 24) FROM tasks "
-              "WHERE is_deleted = 0 AND status = 2 AND completed_at BETWEEN ? AND ? "
+    QSqlQuery q(database());
+    q.prepare("SELECT SUM(duration_hours_sum), SUM(duration_count) FROM task_daily_rollup "
+              "WHERE status = 2 AND day BETWEEN ? AND ? "
               + buildCategoryInClause(f.categoryIds));
-    q.addBindValue(f.start);
-    q.addBindValue(f.end);
-    if (q.exec() && q.next()) return q.value(0).toDouble();
+    q.addBindValue(f.start.date().toString("yyyy-MM-dd"));
+    q.addBindValue(f.end.date().toString("yyyy-MM-dd"));
+    if (QueryProfiler::exec(q, "StatisticModel") && q.next() && q.value(1).toInt() > 0) {
+        return q.value(0).toDouble() / q.value(1).toInt();
+    }
     return 0.0;
 }
 
 int StatisticModel::getInspirationCount(const Filter &f) const
 {
-    QSqlQuery q;
+    QSqlQuery q(database());
     q.prepare("SELECT COUNT(*) FROM inspirations WHERE is_deleted = 0 AND created_at BETWEEN ? AND ?");
     q.addBindValue(f.start);
     q.addBindValue(f.end);
-    if (q.exec() && q.next()) return q.value(0).toInt();
+    if (QueryProfiler::exec(q, "StatisticModel") && q.next()) return q.value(0).toInt();
     return 0;
 }
@@ -5,6 +5,10 @@
 #include <QMap>
 #include <QDateTime>
 #include <QList>
+#include <QVector>
+#include <QSqlDatabase>
+#include <QCache>
+#include "utils/durationsketch.h"
 
 class StatisticModel : public QObject
 {
@@ -17,8 +21,55 @@ public:
         QDateTime start;
         QDateTime end;
         QList<int> categoryIds;
+        // 连同归档库中的任务一起查询，连接需已调用 Database::attachArchive
+        bool includeArchive = false;
     };
 
+    // 按 includeArchive 选择任务表 / 标签关联表或其合并视图
+    static QString taskSource(const Filter &f);
+    static QString tagRelationSource(const Filter &f);
+
+    enum TrendGranularity { TrendDaily, TrendMonthly };
+
+    // 同一耗时指标在整体、各分类、各优先级上的分布
+    struct DurationBreakdown {
+        DurationSketch overall;
+        QMap<QString, DurationSketch> byCategory;
+        QMap<QString, DurationSketch> byPriority;
+    };
+
+    // 统计页一次刷新所需的全部数据
+    struct Snapshot {
+        int total = 0;
+        int completed = 0;
+        int overdue = 0;
+        double rate = 0.0;
+        double avgCompletionHours = 0.0;
+        int inspirationCount = 0;
+        QMap<QString, int> byCategory;
+        QMap<QString, int> byPriority;
+        QMap<QString, int> byStatus;
+        QVector<int> trend;
+        DurationBreakdown leadTime;        // 创建 -> 完成
+        DurationBreakdown completionTime;  // 开始 -> 完成
+        QDate yearHeatmapStart;            // 年度热力图第一格（周一）
+        QVector<int> yearHeatmap;          // 53 周 * 7 天，按天排列
+        QVector<int> weekHourHeatmap;      // 7 天 * 24 小时
+    };
+
+    Snapshot computeSnapshot(const Filter &f, TrendGranularity granularity) const;
+
+    // 结果缓存：按规范化后的筛选条件存放，数据版本变化即失效
+    bool lookupCache(const Filter &f, TrendGranularity granularity, Snapshot &snap) const;
+    void storeCache(const Filter &f, TrendGranularity granularity, const Snapshot &snap, quint64 version) const;
+    bool fillOverview(const Filter &f, Snapshot &snap) const;
+    bool fillTrend(const Filter &f, TrendGranularity granularity, Snapshot &snap) const;
+    bool fillDurations(const Filter &f, Snapshot &snap) const;
+    bool fillHeatmaps(const Filter &f, Snapshot &snap) const;
+
+    // 在工作线程中使用时指定该线程自己的数据库连接
+    void setConnectionName(const QString &connectionName);
+
     QVariantMap getOverviewStats(const Filter &f) const;
     QMap<QString, int> getTasksCountByCategory(const Filter &f) const;
     QMap<QString, int> getTasksCountByPriority(const Filter &f) const;
@@ -32,7 +83,21 @@ public:
     int getInspirationCount(const Filter &f) const;
 
 private:
+    struct CacheEntry {
+        quint64 version;
+        Snapshot snapshot;
+    };
+
+    QString m_connectionName;
+    mutable QCache<QString, CacheEntry> m_cache;
+
+    static QString cacheKey(const Filter &f, TrendGranularity granularity);
+
+    QSqlDatabase database() const;
     QString buildCategoryInClause(const QList<int> &ids) const;
 };
 
+Q_DECLARE_METATYPE(StatisticModel::Filter)
+Q_DECLARE_METATYPE(StatisticModel::Snapshot)
+
 #endif // STATISTICMODEL_H
@@ -1,4 +1,5 @@
 #include "taskitem.h"
+#include "utils/themepalette.h"
 #include <QColor>
 
 QVariantMap TaskItem::toVariantMap() const {
@@ -83,23 +84,11 @@ QString TaskItem::statusText() const {
 }
 
 QColor TaskItem::priorityColor() const {
-    switch (priority) {
-    case 0: return QColor("#C96A6A");
-    case 1: return QColor("#D69E68");
-    case 2: return QColor("#7FA882");
-    case 3: return QColor("#8C949E");
-    default: return QColor("#7696B3");
-    }
+    return ThemePalette::instance().priorityColor(priority);
 }
 
 QColor TaskItem::statusColor() const {
-    switch (status) {
-    case 0: return QColor("#7696B3");
-    case 1: return QColor("#D69E68");
-    case 2: return QColor("#7FA882");
-    case 3: return QColor("#C96A6A");
-    default: return QColor("#8C949E");
-    }
+    return ThemePalette::instance().statusColor(status);
 }
 
 bool TaskItem::isOverdue() const {
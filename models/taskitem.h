@@ -7,7 +7,7 @@
 #include <QList>
 
 struct TaskItem {
-    int id;
+    int id = 0;
     QString title;
     QString description;
     int categoryId;
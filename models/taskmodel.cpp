@@ -1,5 +1,6 @@
 #include "taskmodel.h"
 #include "database/database.h"
+#include "database/queryprofiler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
@@ -19,8 +20,15 @@ static QSqlDatabase getDbConnection()
 TaskModel::TaskModel(QObject *parent)
     : QAbstractTableModel(parent)
     , showingDeleted(false)
+    , syncedSeq(0)
 {
     refresh(false);
+
+    connect(&Database::instance(), &Database::databaseReplaced, this, [this](){
+        refresh(showingDeleted);
+    });
+    // 其他连接（提醒线程、导入线程等）写入的变化在这里增量合并
+    connect(&Database::instance(), &Database::changesAvailable, this, &TaskModel::applyChanges);
 }
 
 TaskModel::~TaskModel()
@@ -160,14 +168,14 @@ QList<int> TaskModel::resolveTagIds(const QStringList &tagNames, const QStringLi
         QSqlQuery checkQuery(db);
         checkQuery.prepare("SELECT id FROM task_tags WHERE name = ?");
         checkQuery.addBindValue(name);
-        if (checkQuery.exec() && checkQuery.next()) {
+        if (QueryProfiler::exec(checkQuery, "TaskModel") && checkQuery.next()) {
             tagIds.append(checkQuery.value(0).toInt());
         } else {
             QSqlQuery insertQuery(db);
             insertQuery.prepare("INSERT INTO task_tags (name, color) VALUES (?, ?)");
             insertQuery.addBindValue(name);
             insertQuery.addBindValue(color);
-            if (insertQuery.exec()) {
+            if (QueryProfiler::exec(insertQuery, "TaskModel")) {
                 tagIds.append(insertQuery.lastInsertId().toInt());
             }
         }
@@ -270,6 +278,8 @@ void TaskModel::loadTasks(bool includeDeleted)
     QSqlDatabase db = getDbConnection();
     if (!db.isOpen()) return;
 
+    syncedSeq = Database::instance().latestChangeSeq();
+
     beginResetModel();
     tasks.clear();
 
@@ -280,7 +290,7 @@ void TaskModel::loadTasks(bool includeDeleted)
     queryStr += "ORDER BY t.priority ASC, t.deadline ASC";
 
     QSqlQuery query(db);
-    if (query.exec(queryStr)) {
+    if (QueryProfiler::exec(query, queryStr, "TaskModel")) {
         while (query.next()) {
             TaskItem task;
             task.id = query.value("id").toInt();
@@ -305,7 +315,7 @@ void TaskModel::loadTasks(bool includeDeleted)
                 QSqlQuery tagQuery(db);
                 tagQuery.prepare("SELECT name, color FROM task_tags WHERE id = ?");
                 tagQuery.addBindValue(tagId);
-                if (tagQuery.exec() && tagQuery.next()) {
+                if (QueryProfiler::exec(tagQuery, "TaskModel") && tagQuery.next()) {
                     task.tagNames.append(tagQuery.value("name").toString());
                     task.tagColors.append(tagQuery.value("color").toString());
                 }
@@ -316,6 +326,92 @@ void TaskModel::loadTasks(bool includeDeleted)
     endResetModel();
 }
 
+static const int kMaxIncrementalTasks = 200;
+
+void TaskModel::syncChanges()
+{
+    applyChanges(Database::instance().changesSince(syncedSeq));
+}
+
+void TaskModel::applyChanges(const QList<ChangeLogEntry> &changes)
+{
+    QList<int> taskIds;
+    bool needReload = false;
+    for (const ChangeLogEntry &change : changes) {
+        if (change.seq <= syncedSeq) continue;
+        syncedSeq = change.seq;
+
+        if (change.table == "tasks" || change.table == "task_tag_relations") {
+            if (!taskIds.contains(change.rowId)) taskIds.append(change.rowId);
+        } else if (change.table == "task_categories" || change.table == "task_tags") {
+            // 分类或标签的名称、颜色冗余在每个任务行中，直接整体重新加载
+            needReload = true;
+        }
+    }
+
+    // 变化行数较多时（如批量导入）逐行查询反而比整体重新加载慢
+    if (needReload || taskIds.size() > kMaxIncrementalTasks) {
+        loadTasks(showingDeleted);
+        return;
+    }
+    for (int taskId : taskIds) applyTaskChange(taskId);
+}
+
+int TaskModel::rowOfTask(int taskId) const
+{
+    for (int row = 0; row < tasks.size(); ++row) {
+        if (tasks[row].id == taskId) return row;
+    }
+    return -1;
+}
+
+// 与 loadTasks 的默认排序一致：优先级升序，再按截止时间升序；skipRow 为任务当前所在行
+int TaskModel::sortedPosition(const TaskItem &task, int skipRow) const
+{
+    int pos = 0;
+    for (int row = 0; row < tasks.size(); ++row) {
+        if (row == skipRow) continue;
+        const TaskItem &other = tasks[row];
+        if (other.priority < task.priority
+            || (other.priority == task.priority && !(task.deadline < other.deadline))) {
+            ++pos;
+        }
+    }
+    return pos;
+}
+
+// 按数据库中的当前状态更新、插入或移除一行，其余行不动
+void TaskModel::applyTaskChange(int taskId)
+{
+    TaskItem task = loadTaskFromDb(taskId);
+    bool visible = task.id == taskId && (showingDeleted || !task.isDeleted);
+    int row = rowOfTask(taskId);
+
+    if (row >= 0 && visible) {
+        // 排序字段变化时把该行移到新位置，保持与整体重新加载相同的顺序
+        if (tasks[row].priority != task.priority || tasks[row].deadline != task.deadline) {
+            int pos = sortedPosition(task, row);
+            if (pos != row) {
+                beginMoveRows(QModelIndex(), row, row, QModelIndex(), pos > row ? pos + 1 : pos);
+                tasks.move(row, pos);
+                endMoveRows();
+                row = pos;
+            }
+        }
+        tasks[row] = task;
+        emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    } else if (row >= 0) {
+        beginRemoveRows(QModelIndex(), row, row);
+        tasks.removeAt(row);
+        endRemoveRows();
+    } else if (visible) {
+        int pos = sortedPosition(task);
+        beginInsertRows(QModelIndex(), pos, pos);
+        tasks.insert(pos, task);
+        endInsertRows();
+    }
+}
+
 TaskItem TaskModel::loadTaskFromDb(int taskId) const
 {
     TaskItem task;
@@ -329,7 +425,7 @@ TaskItem TaskModel::loadTaskFromDb(int taskId) const
                   "WHERE t.id = ?");
     query.addBindValue(taskId);
 
-    if (query.exec() && query.next()) {
+    if (QueryProfiler::exec(query, "TaskModel") && query.next()) {
         task.id = query.value("id").toInt();
         task.title = query.value("title").toString();
         task.description = query.value("description").toString();
@@ -352,7 +448,7 @@ TaskItem TaskModel::loadTaskFromDb(int taskId) const
             QSqlQuery tagQuery(db);
             tagQuery.prepare("SELECT name, color FROM task_tags WHERE id = ?");
             tagQuery.addBindValue(tagId);
-            if (tagQuery.exec() && tagQuery.next()) {
+            if (QueryProfiler::exec(tagQuery, "TaskModel") && tagQuery.next()) {
                 task.tagNames.append(tagQuery.value("name").toString());
                 task.tagColors.append(tagQuery.value("color").toString());
             }
@@ -399,12 +495,13 @@ bool TaskModel::addTask(const QVariantMap &taskData)
     query.bindValue(":updated_at", task.updatedAt);
     query.bindValue(":completed_at", task.completedAt);
 
-    if (!query.exec()) return false;
+    if (!QueryProfiler::exec(query, "TaskModel")) return false;
     task.id = query.lastInsertId().toInt();
 
     if (!task.tagIds.isEmpty()) updateTaskTags(task.id, task.tagIds);
 
-    refresh();
+    Database::instance().markDataChanged();
+    syncChanges();
     emit taskAdded(task.id);
     return true;
 }
@@ -446,16 +543,17 @@ bool TaskModel::updateTask(int taskId, const QVariantMap &taskData)
     query.addBindValue(task.completedAt);
     query.addBindValue(taskId);
 
-    if (!query.exec()) return false;
+    if (!QueryProfiler::exec(query, "TaskModel")) return false;
 
     QSqlQuery deleteQuery(db);
     deleteQuery.prepare("DELETE FROM task_tag_relations WHERE task_id = ?");
     deleteQuery.addBindValue(taskId);
-    deleteQuery.exec();
+    QueryProfiler::exec(deleteQuery, "TaskModel");
 
     if (!task.tagIds.isEmpty()) updateTaskTags(taskId, task.tagIds);
 
-    refresh();
+    Database::instance().markDataChanged();
+    syncChanges();
     emit taskUpdated(taskId);
     return true;
 }
@@ -470,8 +568,9 @@ bool TaskModel::deleteTask(int taskId, bool softDelete)
         query.prepare("UPDATE tasks SET is_deleted = 1, updated_at = ? WHERE id = ?");
         query.addBindValue(getCurrentTimestamp());
         query.addBindValue(taskId);
-        if (!query.exec()) return false;
-        refresh(showingDeleted);
+        if (!QueryProfiler::exec(query, "TaskModel")) return false;
+        Database::instance().markDataChanged();
+        syncChanges();
         emit taskDeleted(taskId);
         return true;
     } else {
@@ -492,7 +591,7 @@ QList<QVariantMap> TaskModel::getDeletedTasks() const
                   "WHERE t.is_deleted = 1 "
                   "ORDER BY t.updated_at DESC");
 
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "TaskModel")) {
         while (query.next()) {
             QVariantMap task;
             QSqlRecord record = query.record();
@@ -506,7 +605,7 @@ QList<QVariantMap> TaskModel::getDeletedTasks() const
                 QSqlQuery tagQuery(db);
                 tagQuery.prepare("SELECT name, color FROM task_tags WHERE id = ?");
                 tagQuery.addBindValue(tagId);
-                if (tagQuery.exec() && tagQuery.next()) {
+                if (QueryProfiler::exec(tagQuery, "TaskModel") && tagQuery.next()) {
                     tagNames.append(tagQuery.value("name").toString());
                     tagColors.append(tagQuery.value("color").toString());
                 }
@@ -526,7 +625,7 @@ int TaskModel::getDeletedTaskCount() const
     if (!db.isOpen()) return 0;
     QSqlQuery query(db);
     query.prepare("SELECT COUNT(*) FROM tasks WHERE is_deleted = 1");
-    if (query.exec() && query.next()) return query.value(0).toInt();
+    if (QueryProfiler::exec(query, "TaskModel") && query.next()) return query.value(0).toInt();
     return 0;
 }
 
@@ -538,8 +637,9 @@ bool TaskModel::restoreTask(int taskId)
     query.prepare("UPDATE tasks SET is_deleted = 0, updated_at = ? WHERE id = ?");
     query.addBindValue(getCurrentTimestamp());
     query.addBindValue(taskId);
-    if (!query.exec()) return false;
-    if (showingDeleted) refresh(true);
+    if (!QueryProfiler::exec(query, "TaskModel")) return false;
+    Database::instance().markDataChanged();
+    syncChanges();
     emit taskRestored(taskId);
     return true;
 }
@@ -553,15 +653,16 @@ bool TaskModel::permanentDeleteTask(int taskId)
         QSqlQuery deleteTagsQuery(db);
         deleteTagsQuery.prepare("DELETE FROM task_tag_relations WHERE task_id = ?");
         deleteTagsQuery.addBindValue(taskId);
-        if (!deleteTagsQuery.exec()) { db.rollback(); return false; }
+        if (!QueryProfiler::exec(deleteTagsQuery, "TaskModel")) { db.rollback(); return false; }
 
         QSqlQuery deleteTaskQuery(db);
         deleteTaskQuery.prepare("DELETE FROM tasks WHERE id = ?");
         deleteTaskQuery.addBindValue(taskId);
-        if (!deleteTaskQuery.exec()) { db.rollback(); return false; }
+        if (!QueryProfiler::exec(deleteTaskQuery, "TaskModel")) { db.rollback(); return false; }
 
         db.commit();
-        refresh(showingDeleted);
+        Database::instance().markDataChanged();
+        syncChanges();
         emit taskPermanentlyDeleted(taskId);
         return true;
     } catch (...) {
@@ -587,7 +688,7 @@ QList<int> TaskModel::loadTaskTags(int taskId) const
     QSqlQuery query(db);
     query.prepare("SELECT tag_id FROM task_tag_relations WHERE task_id = ?");
     query.addBindValue(taskId);
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "TaskModel")) {
         while (query.next()) tagIds.append(query.value("tag_id").toInt());
     }
     return tagIds;
@@ -603,7 +704,7 @@ bool TaskModel::updateTaskTags(int taskId, const QList<int> &tagIds)
         query.prepare("INSERT OR IGNORE INTO task_tag_relations (task_id, tag_id) VALUES (?, ?)");
         query.addBindValue(taskId);
         query.addBindValue(tagId);
-        if (!query.exec()) success = false;
+        if (!QueryProfiler::exec(query, "TaskModel")) success = false;
     }
     return success;
 }
@@ -621,7 +722,7 @@ QList<QVariantMap> TaskModel::getAllTasks(bool includeDeleted) const
     queryStr += "ORDER BY t.created_at DESC";
 
     QSqlQuery query(db);
-    if (query.exec(queryStr)) {
+    if (QueryProfiler::exec(query, queryStr, "TaskModel")) {
         while (query.next()) {
             QVariantMap task;
             for (int i = 0; i < query.record().count(); ++i) {
@@ -641,7 +742,7 @@ QList<QVariantMap> TaskModel::getTasksByStatus(int status) const
     QSqlQuery query(db);
     query.prepare("SELECT * FROM tasks WHERE status = ? AND is_deleted = 0 ORDER BY deadline ASC");
     query.addBindValue(status);
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "TaskModel")) {
         while (query.next()) {
             QVariantMap task;
             for (int i = 0; i < query.record().count(); ++i) {
@@ -661,7 +762,7 @@ QList<QVariantMap> TaskModel::getTasksByCategory(int categoryId) const
     QSqlQuery query(db);
     query.prepare("SELECT * FROM tasks WHERE category_id = ? AND is_deleted = 0 ORDER BY created_at DESC");
     query.addBindValue(categoryId);
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "TaskModel")) {
         while (query.next()) {
             QVariantMap task;
             for (int i = 0; i < query.record().count(); ++i) {
@@ -684,7 +785,7 @@ QList<QVariantMap> TaskModel::getTasksByTag(int tagId) const
                   "WHERE r.tag_id = ? AND t.is_deleted = 0 "
                   "ORDER BY t.created_at DESC");
     query.addBindValue(tagId);
-    if (query.exec()) {
+    if (QueryProfiler::exec(query, "TaskModel")) {
         while (query.next()) {
             QVariantMap task;
             for (int i = 0; i < query.record().count(); ++i) {
@@ -713,7 +814,7 @@ int TaskModel::getTaskCount(bool includeDeleted) const
     QString queryStr = "SELECT COUNT(*) FROM tasks ";
     if (!includeDeleted) queryStr += "WHERE is_deleted = 0";
     QSqlQuery query(db);
-    if (query.exec(queryStr) && query.next()) return query.value(0).toInt();
+    if (QueryProfiler::exec(query, queryStr, "TaskModel") && query.next()) return query.value(0).toInt();
     return 0;
 }
 
@@ -723,7 +824,7 @@ int TaskModel::getCompletedCount() const
     if (!db.isOpen()) return 0;
     QSqlQuery query(db);
     query.prepare("SELECT COUNT(*) FROM tasks WHERE status = 2 AND is_deleted = 0");
-    if (query.exec() && query.next()) return query.value(0).toInt();
+    if (QueryProfiler::exec(query, "TaskModel") && query.next()) return query.value(0).toInt();
     return 0;
 }
 
@@ -746,16 +847,17 @@ void TaskModel::checkOverdueTasks()
     checkQuery.prepare("SELECT COUNT(*) FROM tasks WHERE is_deleted = 0 AND status IN (0, 1) AND deadline < ?");
     checkQuery.addBindValue(now);
 
-    if (checkQuery.exec() && checkQuery.next()) {
+    if (QueryProfiler::exec(checkQuery, "TaskModel") && checkQuery.next()) {
         if (checkQuery.value(0).toInt() > 0) {
             QSqlQuery updateQuery(db);
             updateQuery.prepare("UPDATE tasks SET status = 3, updated_at = ? WHERE is_deleted = 0 AND status IN (0, 1) AND deadline < ?");
             updateQuery.addBindValue(now);
             updateQuery.addBindValue(now);
 
-            if (updateQuery.exec()) {
+            if (QueryProfiler::exec(updateQuery, "TaskModel")) {
                 qDebug() << "检测到逾期任务，已自动更新状态";
-                refresh(showingDeleted);
+                Database::instance().markDataChanged();
+                syncChanges();
             }
         }
     }
@@ -9,6 +9,8 @@
 #include <QMimeData>
 #include "taskitem.h"
 
+struct ChangeLogEntry;
+
 class TaskModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -75,6 +77,9 @@ public:
     QList<QVariantMap> getDeletedTasks() const;
     void checkOverdueTasks();
     void refresh(bool showDeleted = false);
+    // 只重新读取 change_log 中上次同步之后变化过的任务
+    void syncChanges();
+    void applyChanges(const QList<ChangeLogEntry> &changes);
 
     static QMap<int, QString> getPriorityOptions();
     static QMap<int, QString> getStatusOptions();
@@ -96,11 +101,15 @@ private:
     QList<TaskItem> tasks;
     QSqlDatabase db;
     bool showingDeleted;
+    qint64 syncedSeq;
 
     QList<int> resolveTagIds(const QStringList &tagNames, const QStringList &tagColors);
 
     void loadTasks(bool includeDeleted = false);
     TaskItem loadTaskFromDb(int taskId) const;
+    int rowOfTask(int taskId) const;
+    int sortedPosition(const TaskItem &task, int skipRow = -1) const;
+    void applyTaskChange(int taskId);
     QList<int> loadTaskTags(int taskId) const;
     bool updateTaskTags(int taskId, const QList<int> &tagIds);
     QDateTime getCurrentTimestamp() const;
@@ -0,0 +1,65 @@
+#include "archivethread.h"
+#include "database/database.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+
+const int kCheckIntervalMs = 60 * 60 * 1000;
+// 每个事务移动的任务数；两批之间暂停片刻，排队等写锁的界面写入可以先提交
+const int kBatchSize = 500;
+const int kBatchPauseMs = 50;
+
+} // namespace
+
+ArchiveThread::ArchiveThread(QObject *parent) : PeriodicWorker(parent)
+{
+}
+
+void ArchiveThread::run()
+{
+    QString connectionName = QString("archive_thread_%1").arg((quintptr)QThread::currentThreadId());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "ArchiveThread: Failed to open database";
+            return;
+        }
+
+        // 标签关联依赖外键级联删除
+        QSqlQuery(db).exec("PRAGMA foreign_keys = ON");
+        bool attached = Database::attachArchive(db, Database::instance().archivePath());
+
+        bool manual = false;
+        while (!isStopping()) {
+            // 天数为 0 表示关闭自动归档
+            int days = readSetting(db, "archive_after_days", "365").toInt();
+            if (attached && days > 0) {
+                QDateTime cutoff = QDateTime::currentDateTime().addDays(-days);
+                int total = 0;
+                int moved = 0;
+                do {
+                    moved = Database::archiveBatch(db, cutoff, kBatchSize);
+                    if (moved > 0) total += moved;
+                } while (moved == kBatchSize && pause(kBatchPauseMs));
+
+                if (total > 0) {
+                    qDebug() << "已归档任务数:" << total;
+                    Database::instance().markDataChanged();
+                }
+                if (total > 0 || manual) emit archiveFinished(moved < 0 && total == 0 ? -1 : total, manual);
+            } else if (manual) {
+                emit archiveFinished(-1, true);
+            }
+
+            manual = waitForNextRun(kCheckIntervalMs);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
@@ -0,0 +1,23 @@
+#ifndef ARCHIVETHREAD_H
+#define ARCHIVETHREAD_H
+
+#include "periodicworker.h"
+
+// 自动归档线程：定期把完成时间早于 archive_after_days 天的任务分批移入 archive.db，
+// 让主库的任务表保持在日常使用的规模；每批是独立的短事务，统计汇总保持不变。
+// requestRun() 立即按当前设置归档一次（例如用户修改了天数）
+class ArchiveThread : public PeriodicWorker
+{
+    Q_OBJECT
+public:
+    explicit ArchiveThread(QObject *parent = nullptr);
+
+signals:
+    // manual 为 true 表示由 requestRun 触发；movedCount 为 -1 表示失败
+    void archiveFinished(int movedCount, bool manual);
+
+protected:
+    void run() override;
+};
+
+#endif // ARCHIVETHREAD_H
@@ -0,0 +1,195 @@
+#include "backupthread.h"
+#include "database/database.h"
+#include "database/backupengine.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+
+const int kCheckIntervalMs = 10 * 60 * 1000;
+// 基准完整备份超过一周后重新做完整备份，避免差异备份越积越大
+const int kFullBackupDays = 7;
+// 清理变更日志时每条语句删除的行数，避免长时间占用写锁
+const int kPruneBatch = 5000;
+// 变更日志至少保留的时长：同一数据库上的其他进程每秒轮询一次，只要在此期间内同步过就不会丢失增量
+const int kChangeLogKeepHours = 24;
+
+} // namespace
+
+BackupThread::BackupThread(QObject *parent) : PeriodicWorker(parent), m_busy(false)
+{
+}
+
+bool BackupThread::requestBackup(const QString &destPath)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_busy || !m_pendingPath.isEmpty()) return false;
+        m_pendingPath = destPath;
+    }
+    requestRun();
+    return true;
+}
+
+bool BackupThread::isBusy()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_busy || !m_pendingPath.isEmpty();
+}
+
+QString BackupThread::backupDirectory()
+{
+    return QFileInfo(Database::instance().getDatabasePath()).dir().filePath("backups");
+}
+
+void BackupThread::run()
+{
+    QString connectionName = QString("backup_thread_%1").arg((quintptr)QThread::currentThreadId());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "BackupThread: Failed to open database";
+            return;
+        }
+
+        while (!isStopping()) {
+            QString manualPath;
+            {
+                QMutexLocker locker(&m_mutex);
+                manualPath = m_pendingPath;
+                m_pendingPath.clear();
+                m_busy = true;
+            }
+
+            if (!manualPath.isEmpty()) {
+                bool ok = BackupEngine::onlineBackup(Database::instance().getDatabasePath(), manualPath,
+                                                     [this](int done, int total) { return reportProgress(done, total); });
+                emit backupFinished(ok, false, manualPath);
+            } else if (scheduledBackupDue(db)) {
+                QString filePath;
+                bool ok = runScheduledBackup(db, filePath);
+                if (!filePath.isEmpty()) {
+                    emit backupFinished(ok, true, filePath);
+                }
+            }
+            pruneChangeLog(db);
+
+            {
+                QMutexLocker locker(&m_mutex);
+                m_busy = false;
+            }
+            // 手动备份请求通过 requestRun() 提前唤醒
+            waitForNextRun(kCheckIntervalMs);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool BackupThread::reportProgress(int done, int total)
+{
+    emit progressChanged(total > 0 ? (int)((qint64)done * 100 / total) : 100);
+    return !isStopping();
+}
+
+bool BackupThread::scheduledBackupDue(QSqlDatabase &db)
+{
+    if (readSetting(db, "auto_backup_enabled", "false") != "true") return false;
+
+    int hours = readSetting(db, "auto_backup_interval_hours", "24").toInt();
+    if (hours <= 0) hours = 24;
+
+    // 以最近一次定时备份（完整或差异）的时间为准
+    QFileInfoList files = QDir(backupDirectory()).entryInfoList({"task_*.db"}, QDir::Files, QDir::Time);
+    if (files.isEmpty()) return true;
+    return files.first().lastModified().secsTo(QDateTime::currentDateTime()) >= (qint64)hours * 3600;
+}
+
+bool BackupThread::runScheduledBackup(QSqlDatabase &db, QString &filePath)
+{
+    QString dirPath = backupDirectory();
+    if (!QDir().mkpath(dirPath)) {
+        qDebug() << "无法创建备份目录:" << dirPath;
+        return false;
+    }
+    QDir dir(dirPath);
+
+    BackupEngine::LatestSet latest = BackupEngine::latestSet(dirPath);
+    QString baseStamp = BackupEngine::baseStamp(QFileInfo(latest.basePath).fileName());
+
+    qint64 seq = 0;
+    QSqlQuery query(db);
+    if (query.exec("SELECT IFNULL(MAX(seq), 0) FROM change_log") && query.next()) {
+        seq = query.value(0).toLongLong();
+    }
+
+    QDateTime now = QDateTime::currentDateTime();
+    QString stamp = now.toString("yyyyMMdd_HHmmss");
+    // 恢复备份等操作换了备份组标识后，变化序号与基准不再连续，必须重新做完整备份
+    bool needFull = latest.basePath.isEmpty()
+                    || latest.chain != readSetting(db, "backup_chain_id", "")
+                    || QDateTime::fromString(baseStamp, "yyyyMMdd_HHmmss").daysTo(now) >= kFullBackupDays;
+
+    bool ok;
+    if (needFull) {
+        filePath = dir.filePath(BackupEngine::fullBackupName(stamp));
+        ok = BackupEngine::onlineBackup(Database::instance().getDatabasePath(), filePath,
+                                        [this](int done, int total) { return reportProgress(done, total); });
+        // 旧基准之前的变更记录由随后的 pruneChangeLog 按新基准清理
+    } else if (seq > latest.lastSeq) {
+        // 差异备份相对基准完整备份累积，还原时只需基准和最新一份差异
+        filePath = dir.filePath(BackupEngine::diffBackupName(baseStamp, stamp));
+        ok = BackupEngine::writeDifferential(db.connectionName(), filePath, latest.basePath, latest.baseSeq);
+    } else {
+        return true;
+    }
+
+    if (ok) {
+        int keepSets = readSetting(db, "auto_backup_keep_sets", "5").toInt();
+        BackupEngine::rotate(dirPath, qMax(1, keepSets));
+        qDebug() << "定时备份完成:" << filePath;
+    } else {
+        qDebug() << "定时备份失败:" << filePath;
+    }
+    return ok;
+}
+
+void BackupThread::pruneChangeLog(QSqlDatabase &db)
+{
+    // 本进程的界面已同步到 publishedChangeSeq；仍在使用的备份组（基准未满一周，之后还会在其上做差异备份）
+    // 需要基准之后的全部记录，两者取小。其他进程的同步进度不可知，另按时间保留最近 kChangeLogKeepHours 小时
+    qint64 limit = Database::instance().publishedChangeSeq();
+    BackupEngine::LatestSet latest = BackupEngine::latestSet(backupDirectory());
+    if (!latest.basePath.isEmpty()) {
+        QDateTime baseTime = QDateTime::fromString(BackupEngine::baseStamp(QFileInfo(latest.basePath).fileName()),
+                                                   "yyyyMMdd_HHmmss");
+        if (baseTime.isValid() && baseTime.daysTo(QDateTime::currentDateTime()) < kFullBackupDays) {
+            limit = qMin(limit, latest.baseSeq);
+        }
+    }
+    if (limit <= 0) return;
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM change_log WHERE seq <= MIN(?, (SELECT MIN(seq) FROM change_log) + ?) "
+                  "AND changed_at < datetime('now', ?)");
+    int removed = 0;
+    while (!isStopping()) {
+        query.addBindValue(limit);
+        query.addBindValue(kPruneBatch);
+        query.addBindValue(QString("-%1 hours").arg(kChangeLogKeepHours));
+        if (!query.exec()) {
+            qDebug() << "清理变更日志失败:" << query.lastError().text();
+            break;
+        }
+        if (query.numRowsAffected() <= 0) break;
+        removed += query.numRowsAffected();
+    }
+    if (removed > 0) qDebug() << "已清理变更日志:" << removed << "条";
+}
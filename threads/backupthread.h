@@ -0,0 +1,39 @@
+#ifndef BACKUPTHREAD_H
+#define BACKUPTHREAD_H
+
+#include "periodicworker.h"
+
+// 后台备份线程：处理手动备份请求，并在开启定时备份时按间隔做完整或差异备份；
+// 无论是否开启备份，都定期清理界面已同步、差异备份也不再需要的变更日志
+class BackupThread : public PeriodicWorker
+{
+    Q_OBJECT
+public:
+    explicit BackupThread(QObject *parent = nullptr);
+    // 把当前数据库完整备份到 destPath，正在备份时返回 false
+    bool requestBackup(const QString &destPath);
+    bool isBusy();
+
+    static QString backupDirectory();
+
+signals:
+    void progressChanged(int percent);
+    // scheduled 为 true 表示定时备份
+    void backupFinished(bool success, bool scheduled, const QString &filePath);
+
+protected:
+    void run() override;
+
+private:
+    // 由 m_mutex 保护
+    bool m_busy;
+    QString m_pendingPath;
+
+    // 在线备份的进度回调，线程停止时中止备份
+    bool reportProgress(int done, int total);
+    bool scheduledBackupDue(QSqlDatabase &db);
+    bool runScheduledBackup(QSqlDatabase &db, QString &filePath);
+    void pruneChangeLog(QSqlDatabase &db);
+};
+
+#endif // BACKUPTHREAD_H
@@ -0,0 +1,61 @@
+#include "exportthread.h"
+#include "database/database.h"
+#include <QSqlDatabase>
+#include <QDebug>
+
+ExportThread::ExportThread(Job job, const QString &filePath, const StatisticModel::Filter &filter, QObject *parent)
+    : QThread(parent), m_job(job), m_filePath(filePath), m_filter(filter), m_canceled(0)
+{
+}
+
+void ExportThread::setReportContent(const QList<Exporter::ChartPicture> &charts, const QString &aiAnalysisText)
+{
+    m_charts = charts;
+    m_aiAnalysisText = aiAnalysisText;
+}
+
+void ExportThread::cancel()
+{
+    m_canceled.storeRelaxed(1);
+}
+
+void ExportThread::run()
+{
+    QString connectionName = QString("export_thread_%1").arg((quintptr)QThread::currentThreadId());
+    bool ok = false;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "ExportThread: Failed to open database";
+        } else {
+            Database::attachArchive(db, Database::instance().archivePath());
+
+            auto progress = [this](int done, int total) {
+                emit progressChanged(done, total);
+                return m_canceled.loadRelaxed() == 0;
+            };
+
+            switch (m_job) {
+            case TaskCsv:
+                ok = Exporter::exportTasksToCSV(m_filePath, connectionName, m_filter, progress);
+                break;
+            case TaskJsonLines:
+                ok = Exporter::exportToJsonLines(m_filePath, connectionName, m_filter, progress);
+                break;
+            case TaskXlsx:
+                ok = Exporter::exportToXlsx(m_filePath, connectionName, m_filter, progress);
+                break;
+            case ReportPdf:
+                ok = Exporter::exportReportToPDF(m_filePath, connectionName, m_filter, m_charts, m_aiAnalysisText, progress);
+                break;
+            }
+            db.close();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+    emit exportFinished(ok, m_canceled.loadRelaxed() != 0, m_filePath);
+}
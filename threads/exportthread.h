@@ -0,0 +1,37 @@
+#ifndef EXPORTTHREAD_H
+#define EXPORTTHREAD_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include "models/statisticmodel.h"
+#include "utils/exporter.h"
+
+// 导出线程：每次导出任务新建一个，使用自己的数据库连接，完成后自行结束
+class ExportThread : public QThread
+{
+    Q_OBJECT
+public:
+    enum Job { TaskCsv, TaskJsonLines, TaskXlsx, ReportPdf };
+
+    ExportThread(Job job, const QString &filePath, const StatisticModel::Filter &filter, QObject *parent = nullptr);
+    // 报表导出所需的图表和分析文本，须在 start() 之前设置
+    void setReportContent(const QList<Exporter::ChartPicture> &charts, const QString &aiAnalysisText);
+    void cancel();
+
+signals:
+    void progressChanged(int done, int total);
+    void exportFinished(bool success, bool canceled, const QString &filePath);
+
+protected:
+    void run() override;
+
+private:
+    Job m_job;
+    QString m_filePath;
+    StatisticModel::Filter m_filter;
+    QList<Exporter::ChartPicture> m_charts;
+    QString m_aiAnalysisText;
+    QAtomicInt m_canceled;
+};
+
+#endif // EXPORTTHREAD_H
@@ -0,0 +1,41 @@
+#include "importthread.h"
+#include "database/database.h"
+#include <QSqlDatabase>
+#include <QDebug>
+
+ImportThread::ImportThread(const QString &filePath, QObject *parent)
+    : QThread(parent), m_filePath(filePath), m_canceled(0)
+{
+}
+
+void ImportThread::cancel()
+{
+    m_canceled.storeRelaxed(1);
+}
+
+void ImportThread::run()
+{
+    QString connectionName = QString("import_thread_%1").arg((quintptr)QThread::currentThreadId());
+    bool ok = false;
+    Importer::Result result;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "ImportThread: Failed to open database";
+        } else {
+            // 归档库中的任务同样参与去重，附加失败时只按主库去重
+            Database::attachArchive(db, Database::instance().archivePath());
+            ok = Importer::importTasks(m_filePath, connectionName, result, [this](qint64 done, qint64 total) {
+                emit progressChanged(total > 0 ? int(done * 100 / total) : 100);
+                return m_canceled.loadRelaxed() == 0;
+            });
+            db.close();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+    emit importFinished(ok, m_canceled.loadRelaxed() != 0, result.imported, result.duplicates, result.failed);
+}
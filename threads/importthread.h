@@ -0,0 +1,29 @@
+#ifndef IMPORTTHREAD_H
+#define IMPORTTHREAD_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include "utils/importer.h"
+
+// 导入线程：每次导入新建一个，使用自己的数据库连接
+class ImportThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit ImportThread(const QString &filePath, QObject *parent = nullptr);
+    void cancel();
+
+signals:
+    // percent 为已处理的文件比例
+    void progressChanged(int percent);
+    void importFinished(bool success, bool canceled, int imported, int duplicates, int failed);
+
+protected:
+    void run() override;
+
+private:
+    QString m_filePath;
+    QAtomicInt m_canceled;
+};
+
+#endif // IMPORTTHREAD_H
@@ -0,0 +1,56 @@
+#include "periodicworker.h"
+#include <QSqlQuery>
+
+PeriodicWorker::PeriodicWorker(QObject *parent) : QThread(parent), m_stop(false), m_pending(false)
+{
+}
+
+void PeriodicWorker::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    interruptLocked();
+    m_cond.wakeOne();
+}
+
+void PeriodicWorker::requestRun()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending = true;
+    m_cond.wakeOne();
+}
+
+bool PeriodicWorker::isStopping()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stop;
+}
+
+bool PeriodicWorker::pause(int ms)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_stop) m_cond.wait(&m_mutex, ms);
+    return !m_stop;
+}
+
+bool PeriodicWorker::waitForNextRun(int intervalMs)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_stop && !m_pending) {
+        m_cond.wait(&m_mutex, intervalMs);
+    }
+    bool requested = m_pending;
+    m_pending = false;
+    return requested;
+}
+
+QString PeriodicWorker::readSetting(QSqlDatabase &db, const QString &key, const QString &defaultValue)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT value FROM user_settings WHERE key = ?");
+    query.addBindValue(key);
+    if (query.exec() && query.next()) {
+        return query.value(0).toString();
+    }
+    return defaultValue;
+}
@@ -0,0 +1,41 @@
+#ifndef PERIODICWORKER_H
+#define PERIODICWORKER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSqlDatabase>
+
+// 定期执行的后台维护线程（备份、回收站清理、归档）的公共部分：
+// 按间隔或被 requestRun() 唤醒，批次之间可暂停，stop() 随时打断等待
+class PeriodicWorker : public QThread
+{
+    Q_OBJECT
+public:
+    explicit PeriodicWorker(QObject *parent = nullptr);
+    void stop();
+    // 立即执行一轮，不必等到下一个间隔
+    void requestRun();
+
+protected:
+    // m_stop 以及子类需要与 stop() 同步的状态由 m_mutex 保护
+    bool m_stop;
+    QMutex m_mutex;
+
+    bool isStopping();
+    // 两批之间短暂让出写锁，停止时立即返回 false
+    bool pause(int ms);
+    // 等待 intervalMs，或被 requestRun()、stop() 提前唤醒；返回本轮是否由 requestRun() 触发
+    bool waitForNextRun(int intervalMs);
+    // stop() 持有 m_mutex 时调用，子类在这里中止无法分批的长操作
+    virtual void interruptLocked() {}
+
+    // 在线程自己的连接上读取 user_settings，不经过界面线程的主连接
+    static QString readSetting(QSqlDatabase &db, const QString &key, const QString &defaultValue);
+
+private:
+    bool m_pending;
+    QWaitCondition m_cond;
+};
+
+#endif // PERIODICWORKER_H
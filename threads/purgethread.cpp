@@ -0,0 +1,177 @@
+#include "purgethread.h"
+#include "database/database.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QSqlDriver>
+#include <QDateTime>
+#include <QDebug>
+#include <limits>
+#include <sqlite3.h>
+
+namespace {
+
+const int kCheckIntervalMs = 30 * 60 * 1000;
+// 每条 DELETE 删除的行数：行数少、事务短，界面的写入最多等一批
+const int kBatchSize = 200;
+const int kBatchPauseMs = 50;
+// 每次增量 VACUUM 释放的页数
+const int kVacuumPages = 256;
+// 等待一次性 VACUUM 时的检查间隔：整个间隔内没有写入才视为空闲
+const int kIdleCheckMs = 2 * 60 * 1000;
+
+} // namespace
+
+PurgeThread::PurgeThread(QObject *parent) : PeriodicWorker(parent), m_vacuumHandle(nullptr)
+{
+}
+
+void PurgeThread::interruptLocked()
+{
+    // 连接在 m_vacuumHandle 清空之后才会关闭，持锁调用是安全的
+    if (m_vacuumHandle) sqlite3_interrupt(m_vacuumHandle);
+}
+
+void PurgeThread::run()
+{
+    QString connectionName = QString("purge_thread_%1").arg((quintptr)QThread::currentThreadId());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "PurgeThread: Failed to open database";
+            return;
+        }
+
+        // 标签关联依赖外键级联删除
+        QSqlQuery(db).exec("PRAGMA foreign_keys = ON");
+
+        bool vacuumPending = incrementalVacuumPending(db);
+        quint64 idleVersion = std::numeric_limits<quint64>::max();
+
+        while (!isStopping()) {
+            if (vacuumPending) {
+                quint64 version = Database::instance().dataVersion();
+                if (version == idleVersion) vacuumPending = !enableIncrementalVacuum(db);
+                idleVersion = version;
+            }
+
+            if (readSetting(db, "auto_purge_bin", "false") == "true") {
+                int days = readSetting(db, "auto_purge_days", "30").toInt();
+                QDateTime cutoff = QDateTime::currentDateTime().addDays(-qMax(0, days));
+
+                int taskCount = purgeTable(db, "tasks", cutoff);
+                int inspirationCount = purgeTable(db, "inspirations", cutoff);
+                if (taskCount > 0 || inspirationCount > 0) {
+                    qDebug() << "已自动清理回收站:" << taskCount << "个任务," << inspirationCount << "条灵感";
+                    Database::instance().notifyChanges();
+                    emit purgeFinished(taskCount, inspirationCount);
+                }
+                reclaimPages(db);
+            }
+
+            waitForNextRun(vacuumPending ? kIdleCheckMs : kCheckIntervalMs);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool PurgeThread::incrementalVacuumPending(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    return query.exec("PRAGMA user_version") && query.next() && query.value(0).toInt() < 5;
+}
+
+bool PurgeThread::enableIncrementalVacuum(QSqlDatabase &db)
+{
+    // 旧数据库升级到版本 5 的最后一步：整库重写一次以启用 auto_vacuum = INCREMENTAL
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL")) {
+        qDebug() << "设置增量回收失败:" << query.lastError().text();
+        return false;
+    }
+
+    // 与 Qt 文档的做法相同，取出底层句柄供 stop() 中止；程序和 Qt 的 SQLite 驱动链接同一个 sqlite3 库
+    QVariant handle = db.driver()->handle();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stop) return false;
+        if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+            m_vacuumHandle = *static_cast<sqlite3 **>(handle.data());
+        }
+    }
+
+    qDebug() << "空闲中，开始整理数据库以启用增量回收空间";
+    bool ok = query.exec("VACUUM");
+    {
+        QMutexLocker locker(&m_mutex);
+        m_vacuumHandle = nullptr;
+    }
+    if (!ok) {
+        qDebug() << "整理数据库失败或被中止，下次空闲时重试:" << query.lastError().text();
+        return false;
+    }
+
+    // 结构版本变化后，差异备份无法叠加到之前的完整备份上（还原时会校验版本），
+    // 版本号和新的备份组标识一起提交，下一次定时备份改做完整备份
+    ok = db.transaction()
+         && query.exec("PRAGMA user_version = 5")
+         && Database::startNewBackupChain(db);
+    if (!ok || !db.commit()) {
+        qDebug() << "写入数据库版本失败:" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+    qDebug() << "已启用增量回收空间";
+    return true;
+}
+
+int PurgeThread::purgeTable(QSqlDatabase &db, const QString &table, const QDateTime &cutoff)
+{
+    // 移入回收站时会更新 updated_at，以此作为删除时间
+    QSqlQuery query(db);
+    query.prepare(QString("DELETE FROM %1 WHERE id IN "
+                          "(SELECT id FROM %1 WHERE is_deleted = 1 AND updated_at < ? LIMIT ?)").arg(table));
+
+    int total = 0;
+    while (!isStopping()) {
+        query.addBindValue(cutoff);
+        query.addBindValue(kBatchSize);
+        if (!query.exec()) {
+            qDebug() << "清理回收站失败:" << table << query.lastError().text();
+            break;
+        }
+        int removed = query.numRowsAffected();
+        total += removed;
+        if (removed < kBatchSize || !pause(kBatchPauseMs)) break;
+    }
+    return total;
+}
+
+void PurgeThread::reclaimPages(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    // 只有 auto_vacuum = INCREMENTAL 的数据库才能增量回收
+    if (!query.exec("PRAGMA auto_vacuum") || !query.next() || query.value(0).toInt() != 2) return;
+
+    int lastFreePages = -1;
+    while (!isStopping()) {
+        int freePages = 0;
+        if (query.exec("PRAGMA freelist_count") && query.next()) {
+            freePages = query.value(0).toInt();
+        }
+        if (freePages <= 0 || freePages == lastFreePages) break;
+        lastFreePages = freePages;
+
+        // 每释放一页返回一行，需要逐行读完才会真正执行
+        if (!query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(kVacuumPages))) {
+            qDebug() << "增量回收空间失败:" << query.lastError().text();
+            break;
+        }
+        while (query.next()) {}
+        query.finish();
+        if (!pause(kBatchPauseMs)) break;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef PURGETHREAD_H
+#define PURGETHREAD_H
+
+#include "periodicworker.h"
+
+struct sqlite3;
+
+// 回收站自动清理线程：开启 auto_purge_bin 时定期分批永久删除过期的回收站项目，
+// 再用增量 VACUUM 把空闲页还给文件系统；每批都是独立的短事务，不会长时间占用写锁。
+// 旧数据库启用增量回收所需的一次性 VACUUM 也在这里、应用空闲时执行。它是例外：
+// 整库重写期间一直持有写锁，界面的写入会等待，超过忙等超时（5 秒）就会失败。
+// 因此只在连续一个检查间隔没有写入时才开始，stop() 会用 sqlite3_interrupt 立即中止它
+// （事务回滚，数据库不变，下次空闲时重试），退出和恢复备份不必等它做完。
+// 刚开启自动清理时用 requestRun() 立即检查一次
+class PurgeThread : public PeriodicWorker
+{
+    Q_OBJECT
+public:
+    explicit PurgeThread(QObject *parent = nullptr);
+
+signals:
+    void purgeFinished(int taskCount, int inspirationCount);
+
+protected:
+    void run() override;
+    void interruptLocked() override;
+
+private:
+    sqlite3 *m_vacuumHandle;     // 正在执行一次性 VACUUM 的连接，由 m_mutex 保护
+    bool incrementalVacuumPending(QSqlDatabase &db);
+    bool enableIncrementalVacuum(QSqlDatabase &db);
+    int purgeTable(QSqlDatabase &db, const QString &table, const QDateTime &cutoff);
+    void reclaimPages(QSqlDatabase &db);
+};
+
+#endif // PURGETHREAD_H
@@ -35,6 +35,7 @@ void RemindThread::run()
             overdueQuery.addBindValue(QDateTime::currentDateTime());
 
             if (overdueQuery.exec() && overdueQuery.numRowsAffected() > 0) {
+                Database::instance().markDataChanged();
                 emit taskOverdueUpdated();
             }
 
@@ -43,6 +44,7 @@ void RemindThread::run()
             remindQuery.addBindValue(QDateTime::currentDateTime());
 
             if (remindQuery.exec()) {
+                bool reminded = false;
                 while (remindQuery.next()) {
                     int id = remindQuery.value("id").toInt();
                     QString title = remindQuery.value("title").toString();
@@ -52,8 +54,10 @@ void RemindThread::run()
                     QSqlQuery updateQuery(db);
                     updateQuery.prepare("UPDATE tasks SET is_reminded = 1 WHERE id = ?");
                     updateQuery.addBindValue(id);
-                    updateQuery.exec();
+                    reminded = updateQuery.exec() || reminded;
                 }
+                // 提醒标记不影响统计，只让界面增量同步这几行
+                if (reminded) Database::instance().notifyChanges();
             }
 
             QMutexLocker locker(&m_mutex);
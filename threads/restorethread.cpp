@@ -0,0 +1,77 @@
+#include "restorethread.h"
+#include "database/database.h"
+#include "database/backupengine.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QFile>
+#include <QDebug>
+
+RestoreThread::RestoreThread(const QString &backupPath, const QString &stagedPath, QObject *parent)
+    : QThread(parent), m_backupPath(backupPath), m_stagedPath(stagedPath), m_canceled(0)
+{
+}
+
+void RestoreThread::cancel()
+{
+    m_canceled.storeRelaxed(1);
+}
+
+void RestoreThread::run()
+{
+    QFile::remove(m_stagedPath);
+
+    auto progress = [this](int done, int total) {
+        // 复制占进度的九成，其余留给校验
+        emit progressChanged(total > 0 ? (int)((qint64)done * 90 / total) : 90);
+        return m_canceled.loadRelaxed() == 0;
+    };
+
+    QString message;
+    if (!BackupEngine::materialize(m_backupPath, m_stagedPath, progress)) {
+        message = "无法读取备份文件，可能已损坏或缺少对应的基准备份。";
+    } else if (m_canceled.loadRelaxed() == 0) {
+        message = validate();
+    }
+
+    bool canceled = m_canceled.loadRelaxed() != 0;
+    bool ok = !canceled && message.isEmpty();
+    if (!ok) {
+        QFile::remove(m_stagedPath);
+    } else {
+        emit progressChanged(100);
+    }
+    emit restoreReady(ok, canceled, message);
+}
+
+// 返回空字符串表示通过
+QString RestoreThread::validate()
+{
+    QString connectionName = QString("restore_thread_%1").arg((quintptr)QThread::currentThreadId());
+    QString message;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(m_stagedPath);
+
+        if (!db.open()) {
+            message = "无法打开备份文件。";
+        } else {
+            QSqlQuery query(db);
+            if (!query.exec("PRAGMA integrity_check") || !query.next() || query.value(0).toString() != "ok") {
+                qDebug() << "备份完整性检查未通过:" << query.value(0).toString();
+                message = "备份文件已损坏（完整性检查未通过）。";
+            } else if (!query.exec("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' "
+                                   "AND name IN ('tasks', 'inspirations', 'task_categories', 'user_settings')")
+                       || !query.next() || query.value(0).toInt() != 4) {
+                message = "所选文件不是本程序的数据库备份。";
+            } else if (!query.exec("PRAGMA user_version") || !query.next()
+                       || query.value(0).toInt() > Database::SchemaVersion) {
+                message = "备份来自更新版本的程序，无法在当前版本中恢复。";
+            }
+            db.close();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(connectionName);
+    return message;
+}
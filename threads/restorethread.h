@@ -0,0 +1,32 @@
+#ifndef RESTORETHREAD_H
+#define RESTORETHREAD_H
+
+#include <QThread>
+#include <QAtomicInt>
+
+// 恢复线程：把备份（完整或差异）还原到与数据库同目录的暂存文件并校验，
+// 校验通过后由界面线程调用 Database::replaceDatabase 换入
+class RestoreThread : public QThread
+{
+    Q_OBJECT
+public:
+    RestoreThread(const QString &backupPath, const QString &stagedPath, QObject *parent = nullptr);
+    void cancel();
+
+signals:
+    void progressChanged(int percent);
+    // 失败时 message 为原因，暂存文件已删除
+    void restoreReady(bool success, bool canceled, const QString &message);
+
+protected:
+    void run() override;
+
+private:
+    QString m_backupPath;
+    QString m_stagedPath;
+    QAtomicInt m_canceled;
+
+    QString validate();
+};
+
+#endif // RESTORETHREAD_H
@@ -0,0 +1,88 @@
+#include "statisticthread.h"
+#include "database/database.h"
+#include <QSqlDatabase>
+#include <QDebug>
+
+StatisticThread::StatisticThread(QObject *parent)
+    : QThread(parent), m_stop(false), m_hasRequest(false)
+{
+    qRegisterMetaType<StatisticModel::Snapshot>("StatisticModel::Snapshot");
+}
+
+void StatisticThread::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    m_cond.wakeOne();
+}
+
+void StatisticThread::requestStats(quint64 generation, const StatisticModel::Filter &filter,
+                                   StatisticModel::TrendGranularity granularity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_request.generation = generation;
+    m_request.filter = filter;
+    m_request.granularity = granularity;
+    m_hasRequest = true;
+    m_cond.wakeOne();
+}
+
+bool StatisticThread::isSuperseded()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stop || m_hasRequest;
+}
+
+void StatisticThread::run()
+{
+    QString connectionName = QString("statistic_thread_%1").arg((quintptr)QThread::currentThreadId());
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(Database::instance().getDatabasePath());
+
+        if (!db.open()) {
+            qDebug() << "StatisticThread: Failed to open database";
+            return;
+        }
+        Database::attachArchive(db, Database::instance().archivePath());
+
+        StatisticModel model;
+        model.setConnectionName(connectionName);
+
+        while (true) {
+            Request request;
+            {
+                QMutexLocker locker(&m_mutex);
+                while (!m_stop && !m_hasRequest) {
+                    m_cond.wait(&m_mutex);
+                }
+                if (m_stop) break;
+                request = m_request;
+                m_hasRequest = false;
+            }
+
+            StatisticModel::Snapshot snapshot;
+            if (model.lookupCache(request.filter, request.granularity, snapshot)) {
+                emit overviewReady(request.generation, snapshot);
+                emit trendReady(request.generation, snapshot);
+                continue;
+            }
+
+            // 先算轻量的概览，再算趋势；期间有新请求就放弃本次结果
+            quint64 version = Database::instance().dataVersion();
+            bool ok = model.fillOverview(request.filter, snapshot);
+            if (isSuperseded()) continue;
+            emit overviewReady(request.generation, snapshot);
+
+            ok = model.fillTrend(request.filter, request.granularity, snapshot) && ok;
+            ok = model.fillDurations(request.filter, snapshot) && ok;
+            ok = model.fillHeatmaps(request.filter, snapshot) && ok;
+            if (ok) model.storeCache(request.filter, request.granularity, snapshot, version);
+            if (isSuperseded()) continue;
+            emit trendReady(request.generation, snapshot);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
@@ -0,0 +1,43 @@
+#ifndef STATISTICTHREAD_H
+#define STATISTICTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include "models/statisticmodel.h"
+
+// 统计计算线程：只保留最新一次请求，过期请求在阶段之间被丢弃
+class StatisticThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit StatisticThread(QObject *parent = nullptr);
+    void stop();
+
+    void requestStats(quint64 generation, const StatisticModel::Filter &filter,
+                      StatisticModel::TrendGranularity granularity);
+
+signals:
+    void overviewReady(quint64 generation, const StatisticModel::Snapshot &snapshot);
+    void trendReady(quint64 generation, const StatisticModel::Snapshot &snapshot);
+
+protected:
+    void run() override;
+
+private:
+    struct Request {
+        quint64 generation = 0;
+        StatisticModel::Filter filter;
+        StatisticModel::TrendGranularity granularity = StatisticModel::TrendDaily;
+    };
+
+    bool m_stop;
+    bool m_hasRequest;
+    Request m_request;
+    QMutex m_mutex;
+    QWaitCondition m_cond;
+
+    bool isSuperseded();
+};
+
+#endif // STATISTICTHREAD_H
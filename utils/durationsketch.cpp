@@ -0,0 +1,90 @@
+#include "durationsketch.h"
+#include <QtMath>
+
+static const QVector<double> &bucketUppers()
+{
+    static const QVector<double> uppers = []() {
+        QVector<double> v(DurationSketch::BucketCount);
+        double upper = DurationSketch::MinHours;
+        for (int i = 0; i < v.size(); ++i) {
+            v[i] = upper;
+            upper *= DurationSketch::Gamma;
+        }
+        return v;
+    }();
+    return uppers;
+}
+
+double DurationSketch::bucketUpper(int index)
+{
+    return bucketUppers().at(qBound(0, index, BucketCount - 1));
+}
+
+double DurationSketch::bucketValue(int index)
+{
+    if (index <= 0) return MinHours / 2;
+    if (index >= BucketCount - 1) return bucketUpper(BucketCount - 2);
+    // 取使上下界相对误差相等的点
+    return 2.0 * bucketUpper(index) / (Gamma + 1.0);
+}
+
+int DurationSketch::bucketIndex(double hours)
+{
+    if (!(hours > MinHours)) return 0;
+
+    // 先用对数估算，再对照边界表修正浮点误差，保证和数据库里的边界表一致
+    const QVector<double> &uppers = bucketUppers();
+    int index = qBound(0, (int)qCeil(qLn(hours / MinHours) / qLn(Gamma)), BucketCount - 1);
+    while (index > 0 && uppers[index - 1] >= hours) --index;
+    while (index < BucketCount - 1 && uppers[index] < hours) ++index;
+    return index;
+}
+
+void DurationSketch::add(int bucket, qint64 count)
+{
+    if (count == 0) return;
+    if (m_counts.isEmpty()) m_counts.fill(0, BucketCount);
+    m_counts[qBound(0, bucket, BucketCount - 1)] += count;
+    m_total += count;
+}
+
+void DurationSketch::addValue(double hours)
+{
+    add(bucketIndex(hours));
+}
+
+void DurationSketch::merge(const DurationSketch &other)
+{
+    if (other.isEmpty()) return;
+    if (m_counts.isEmpty()) m_counts.fill(0, BucketCount);
+    for (int i = 0; i < BucketCount; ++i) m_counts[i] += other.m_counts[i];
+    m_total += other.m_total;
+}
+
+double DurationSketch::quantile(double q) const
+{
+    if (m_total == 0) return 0.0;
+
+    qint64 rank = (qint64)qFloor(qBound(0.0, q, 1.0) * (m_total - 1));
+    qint64 seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += m_counts[i];
+        if (seen > rank) return bucketValue(i);
+    }
+    return bucketValue(BucketCount - 1);
+}
+
+QVector<int> DurationSketch::histogram(const QVector<double> &edges) const
+{
+    QVector<int> bins(edges.size() + 1, 0);
+    if (m_total == 0) return bins;
+
+    for (int i = 0; i < BucketCount; ++i) {
+        if (m_counts[i] == 0) continue;
+        double value = bucketValue(i);
+        int bin = 0;
+        while (bin < edges.size() && value >= edges[bin]) ++bin;
+        bins[bin] += (int)m_counts[i];
+    }
+    return bins;
+}
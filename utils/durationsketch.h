@@ -0,0 +1,38 @@
+#ifndef DURATIONSKETCH_H
+#define DURATIONSKETCH_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// 耗时分布草图：按对数分桶计数，桶边界逐个放大 Gamma 倍。
+// 两个草图按桶相加即可合并，分位数的相对误差不超过 (Gamma-1)/(Gamma+1)，约 9%
+class DurationSketch
+{
+public:
+    static constexpr int BucketCount = 80;
+    static constexpr double Gamma = 1.2;
+    static constexpr double MinHours = 1.0 / 60.0;
+
+    // 第 index 个桶的上界（小时），最后一个桶收纳所有更大的值
+    static double bucketUpper(int index);
+    // 桶内的代表值，用于估算分位数
+    static double bucketValue(int index);
+    static int bucketIndex(double hours);
+
+    void add(int bucket, qint64 count = 1);
+    void addValue(double hours);
+    void merge(const DurationSketch &other);
+
+    bool isEmpty() const { return m_total == 0; }
+    qint64 count() const { return m_total; }
+    double quantile(double q) const;
+
+    // 按给定边界（小时，递增）统计直方图，结果比边界多一个区间
+    QVector<int> histogram(const QVector<double> &edges) const;
+
+private:
+    QVector<qint64> m_counts;
+    qint64 m_total = 0;
+};
+
+#endif // DURATIONSKETCH_H
@@ -1,214 +1,801 @@
 #include "exporter.h"
-#include "models/taskmodel.h"
+#include "widgets/simplechartwidget.h"
+#include "utils/zipwriter.h"
 #include <QFile>
 #include <QTextStream>
-#include <QPrinter>
-#include <QTextDocument>
+#include <QPdfWriter>
+#include <QPainter>
 #include <QDateTime>
-#include <QBuffer>
-#include <QTextOption>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+// 导出共用的筛选条件，绑定参数依次为 f.start、f.end
+static QString taskWhereClause(const StatisticModel::Filter &f)
+{
+    QString catClause;
+    if (!f.categoryIds.isEmpty()) {
+        QStringList strIds;
+        for (int id : f.categoryIds) strIds << QString::number(id);
+        catClause = QString(" AND t.category_id IN (%1) ").arg(strIds.join(","));
+    }
+    return "WHERE t.is_deleted = 0 AND t.deadline BETWEEN ? AND ? " + catClause;
+}
+
+static int countTasks(const QSqlDatabase &db, const StatisticModel::Filter &f)
+{
+    QSqlQuery q(db);
+    q.prepare("SELECT COUNT(*) FROM " + StatisticModel::taskSource(f) + " t " + taskWhereClause(f));
+    q.addBindValue(f.start);
+    q.addBindValue(f.end);
+    if (q.exec() && q.next()) return q.value(0).toInt();
+    return 0;
+}
+
+static int countInspirations(const QSqlDatabase &db, const StatisticModel::Filter &f)
+{
+    QSqlQuery q(db);
+    q.prepare("SELECT COUNT(*) FROM inspirations WHERE is_deleted = 0 AND created_at BETWEEN ? AND ?");
+    q.addBindValue(f.start);
+    q.addBindValue(f.end);
+    if (q.exec() && q.next()) return q.value(0).toInt();
+    return 0;
+}
 
-bool Exporter::exportTasksToCSV(const QString &filePath, TaskModel *model, const StatisticModel::Filter &f)
+// 各导出格式共用的任务游标：只向前遍历，columns 中任务表别名为 t，分类表别名为 c
+static bool execTaskQuery(QSqlQuery &q, const QString &columns, const StatisticModel::Filter &f)
 {
+    q.setForwardOnly(true);
+    q.prepare("SELECT " + columns + " FROM " + StatisticModel::taskSource(f) + " t LEFT JOIN task_categories c ON t.category_id = c.id "
+              + taskWhereClause(f) + "ORDER BY t.created_at DESC");
+    q.addBindValue(f.start);
+    q.addBindValue(f.end);
+    if (!q.exec()) {
+        qDebug() << "导出查询失败:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+static bool execInspirationQuery(QSqlQuery &q, const QString &columns, const StatisticModel::Filter &f)
+{
+    q.setForwardOnly(true);
+    q.prepare("SELECT " + columns + " FROM inspirations "
+              "WHERE is_deleted = 0 AND created_at BETWEEN ? AND ? ORDER BY created_at DESC");
+    q.addBindValue(f.start);
+    q.addBindValue(f.end);
+    if (!q.exec()) {
+        qDebug() << "导出灵感查询失败:" << q.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+static QString priorityNameExpr()
+{
+    return "CASE IFNULL(t.priority, 0) WHEN 0 THEN '紧急' WHEN 1 THEN '重要' WHEN 2 THEN '普通' ELSE '不急' END";
+}
+
+static QString statusNameExpr()
+{
+    return "CASE IFNULL(t.status, 0) WHEN 0 THEN '待办' WHEN 1 THEN '进行中' WHEN 2 THEN '已完成' ELSE '已延期' END";
+}
+
+// 导入时用于去重的全局编号：有外部编号时沿用，本地任务为“数据库编号:任务 id”
+static QString externalIdExpr()
+{
+    return "IFNULL(t.external_id, (SELECT value FROM user_settings WHERE key = 'database_uuid') || ':' || t.id)";
+}
+
+// 任务的标签名，用 separator 连接成一列
+static QString tagListExpr(const QString &separator, const StatisticModel::Filter &f)
+{
+    return QString("(SELECT GROUP_CONCAT(g.name, %1) FROM %2 r "
+                   "JOIN task_tags g ON g.id = r.tag_id WHERE r.task_id = t.id)")
+        .arg(separator, StatisticModel::tagRelationSource(f));
+}
+
+bool Exporter::exportTasksToCSV(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                const std::function<bool(int, int)> &progress)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    int total = countTasks(db, f);
+
+    // 筛选和格式化都在 SQL 中完成，每行只取回一列拼好的文本
+    QSqlQuery q(db);
+    bool ok = execTaskQuery(q, "t.id || ',\"' || replace(IFNULL(" + externalIdExpr() + ", ''), '\"', '\"\"') || '\",\"' "
+                               "|| replace(t.title, '\"', '\"\"') || '\",\"' "
+                               "|| replace(IFNULL(NULLIF(c.name, ''), '未分类'), '\"', '\"\"') || '\",' "
+                               "|| " + priorityNameExpr() + " || ',' "
+                               "|| " + statusNameExpr() + " || ',' "
+                               "|| IFNULL(strftime('%Y-%m-%d %H:%M', t.created_at), '') || ',' "
+                               "|| IFNULL(strftime('%Y-%m-%d %H:%M', t.completed_at), '-') || ',' "
+                               "|| IFNULL(strftime('%Y-%m-%d %H:%M', t.deadline), '') || ',\"' "
+                               "|| replace(replace(IFNULL(t.description, ''), '\"', '\"\"'), char(10), ' ') || '\"'", f);
+    if (!ok) return false;
+
     QFile file(filePath);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
 
+    // QTextStream 自带写缓冲，逐行写出，内存占用与行数无关
     QTextStream out(&file);
     out << QString::fromUtf8("\xEF\xBB\xBF");
-    out << "ID,标题,分类,优先级,状态,创建时间,完成时间,截止时间,描述\n";
+    out << "ID,外部编号,标题,分类,优先级,状态,创建时间,完成时间,截止时间,描述\n";
+
+    int done = 0;
+    while (q.next()) {
+        out << q.value(0).toString() << '\n';
+        if (++done % 1000 == 0 && progress && !progress(done, total)) {
+            ok = false;
+            break;
+        }
+    }
+    if (ok && progress) ok = progress(done, qMax(total, done));
+
+    out.flush();
+    ok = ok && out.status() == QTextStream::Ok;
+    file.close();
+    if (!ok) file.remove();
+    return ok;
+}
 
-    QList<QVariantMap> allTasks = model->getAllTasks(false);
-    for (const QVariantMap &task : allTasks) {
-        QDateTime dl = task["deadline"].toDateTime();
-        if (dl < f.start || dl > f.end) continue;
-        if (!f.categoryIds.isEmpty() && !f.categoryIds.contains(task["category_id"].toInt())) continue;
+static QJsonValue jsonTime(const QVariant &value)
+{
+    return value.isNull() ? QJsonValue() : QJsonValue(value.toString());
+}
 
-        QStringList row;
-        row << task["id"].toString();
-        row << "\"" + task["title"].toString().replace("\"", "\"\"") + "\"";
+static QJsonArray jsonTags(const QString &tags, QChar separator)
+{
+    QJsonArray array;
+    for (const QString &tag : tags.split(separator, Qt::SkipEmptyParts)) {
+        QString name = tag.trimmed();
+        if (!name.isEmpty()) array.append(name);
+    }
+    return array;
+}
+
+bool Exporter::exportToJsonLines(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                 const std::function<bool(int, int)> &progress)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    int total = countTasks(db, f) + countInspirations(db, f);
 
-        QString catName = task["category_name"].toString();
-        row << (catName.isEmpty() ? "未分类" : catName);
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    // 每行一个 JSON 对象，type 区分任务和灵感；时间统一为 ISO 8601，缺失为 null
+    const QString isoTime = "strftime('%Y-%m-%dT%H:%M:%S', %1)";
+    int done = 0;
+    bool ok = true;
+    auto step = [&]() {
+        if (++done % 1000 == 0 && progress && !progress(done, total)) ok = false;
+    };
 
-        int p = task["priority"].toInt();
-        row << (p==0?"紧急": (p==1?"重要": (p==2?"普通":"不急")));
+    QSqlQuery q(db);
+    ok = execTaskQuery(q, "t.id, t.title, t.description, c.name, " + tagListExpr("char(31)", f) + ", t.priority, t.status, "
+                          + isoTime.arg("t.start_time") + ", " + isoTime.arg("t.deadline") + ", "
+                          + isoTime.arg("t.remind_time") + ", " + isoTime.arg("t.created_at") + ", "
+                          + isoTime.arg("t.updated_at") + ", " + isoTime.arg("t.completed_at") + ", "
+                          + externalIdExpr(), f);
+    while (ok && q.next()) {
+        QJsonObject task;
+        task["type"] = "task";
+        task["id"] = q.value(0).toInt();
+        task["title"] = q.value(1).toString();
+        task["description"] = q.value(2).toString();
+        task["category"] = q.value(3).isNull() ? QJsonValue() : QJsonValue(q.value(3).toString());
+        task["tags"] = jsonTags(q.value(4).toString(), QChar(31));
+        task["priority"] = q.value(5).toInt();
+        task["status"] = q.value(6).toInt();
+        task["start_time"] = jsonTime(q.value(7));
+        task["deadline"] = jsonTime(q.value(8));
+        task["remind_time"] = jsonTime(q.value(9));
+        task["created_at"] = jsonTime(q.value(10));
+        task["updated_at"] = jsonTime(q.value(11));
+        task["completed_at"] = jsonTime(q.value(12));
+        task["external_id"] = q.value(13).isNull() ? QJsonValue() : QJsonValue(q.value(13).toString());
+
+        ok = file.write(QJsonDocument(task).toJson(QJsonDocument::Compact)) >= 0 && file.write("\n", 1) == 1;
+        if (ok) step();
+    }
 
-        int s = task["status"].toInt();
-        row << (s==0?"待办": (s==1?"进行中": (s==2?"已完成":"已延期")));
+    if (ok) {
+        q = QSqlQuery(db);
+        ok = execInspirationQuery(q, "id, content, tags, " + isoTime.arg("created_at") + ", " + isoTime.arg("updated_at"), f);
+    }
+    while (ok && q.next()) {
+        QJsonObject inspiration;
+        inspiration["type"] = "inspiration";
+        inspiration["id"] = q.value(0).toInt();
+        inspiration["content"] = q.value(1).toString();
+        inspiration["tags"] = jsonTags(q.value(2).toString(), ',');
+        inspiration["created_at"] = jsonTime(q.value(3));
+        inspiration["updated_at"] = jsonTime(q.value(4));
+
+        ok = file.write(QJsonDocument(inspiration).toJson(QJsonDocument::Compact)) >= 0 && file.write("\n", 1) == 1;
+        if (ok) step();
+    }
+    if (ok && progress) ok = progress(done, qMax(total, done));
 
-        row << task["created_at"].toDateTime().toString("yyyy-MM-dd HH:mm");
+    file.close();
+    if (!ok) file.remove();
+    return ok;
+}
 
-        QDateTime compAt = task["completed_at"].toDateTime();
-        row << (compAt.isValid() ? compAt.toString("yyyy-MM-dd HH:mm") : "-");
+namespace {
 
-        row << dl.toString("yyyy-MM-dd HH:mm");
-        row << "\"" + task["description"].toString().replace("\"", "\"\"").replace("\n", " ") + "\"";
+const int kSheetRowLimit = 1048576;
+const int kXlsxFlushSize = 64 * 1024;
+// 样式序号，与 xlsxStyles() 中 cellXfs 的顺序对应
+enum XlsxStyle { XlsxNormal = 0, XlsxHeader = 1, XlsxDateTime = 2 };
 
-        out << row.join(",") << "\n";
+void appendXmlEscaped(QByteArray &out, const QByteArray &utf8)
+{
+    // 需要转义的都是 ASCII 字符，直接在 UTF-8 字节上处理；XML 不允许的控制字符丢弃
+    for (char ch : utf8) {
+        switch (ch) {
+        case '&': out.append("&amp;"); break;
+        case '<': out.append("&lt;"); break;
+        case '>': out.append("&gt;"); break;
+        case '"': out.append("&quot;"); break;
+        default:
+            if (uchar(ch) >= 0x20 || ch == '\t' || ch == '\n' || ch == '\r') out.append(ch);
+        }
     }
-    file.close();
-    return true;
 }
 
-bool Exporter::exportReportToPDF(const QString &filePath, TaskModel *taskModel, StatisticModel *statModel,
-                                 const StatisticModel::Filter &f, const QList<QPixmap> &chartPixmaps,
-                                 const QString &aiAnalysisText)
+void appendCellRef(QByteArray &out, int column, int row)
+{
+    char letters[4];
+    int n = 0;
+    for (int c = column + 1; c > 0; c = (c - 1) / 26) letters[n++] = char('A' + (c - 1) % 26);
+    while (n > 0) out.append(letters[--n]);
+    out.append(QByteArray::number(row));
+}
+
+void appendStringCell(QByteArray &out, int column, int row, const QVariant &value, int style = XlsxNormal)
+{
+    if (value.isNull()) return;
+    out.append("<c r=\"");
+    appendCellRef(out, column, row);
+    if (style != XlsxNormal) out.append("\" s=\"").append(QByteArray::number(style));
+    out.append("\" t=\"inlineStr\"><is><t xml:space=\"preserve\">");
+    appendXmlEscaped(out, value.toString().toUtf8());
+    out.append("</t></is></c>");
+}
+
+void appendNumberCell(QByteArray &out, int column, int row, const QVariant &value, int style = XlsxNormal)
+{
+    if (value.isNull()) return;
+    out.append("<c r=\"");
+    appendCellRef(out, column, row);
+    if (style != XlsxNormal) out.append("\" s=\"").append(QByteArray::number(style));
+    out.append("\"><v>").append(QByteArray::number(value.toDouble(), 'g', 15)).append("</v></c>");
+}
+
+QByteArray xmlHeader()
+{
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n";
+}
+
+QByteArray xlsxContentTypes()
+{
+    return xmlHeader() +
+           "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+           "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+           "<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+           "<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+           "<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+           "<Override PartName=\"/xl/worksheets/sheet2.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+           "<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+           "</Types>";
+}
+
+QByteArray xlsxRootRels()
+{
+    return xmlHeader() +
+           "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+           "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument\" Target=\"xl/workbook.xml\"/>"
+           "</Relationships>";
+}
+
+QByteArray xlsxWorkbook()
+{
+    return xmlHeader() +
+           "<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" "
+           "xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\"><sheets>"
+           "<sheet name=\"任务\" sheetId=\"1\" r:id=\"rId1\"/>"
+           "<sheet name=\"灵感\" sheetId=\"2\" r:id=\"rId2\"/>"
+           "</sheets></workbook>";
+}
+
+QByteArray xlsxWorkbookRels()
+{
+    return xmlHeader() +
+           "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+           "<Relationship Id=\"rId1\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+           "<Relationship Id=\"rId2\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet\" Target=\"worksheets/sheet2.xml\"/>"
+           "<Relationship Id=\"rId3\" Type=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles\" Target=\"styles.xml\"/>"
+           "</Relationships>";
+}
+
+QByteArray xlsxStyles()
+{
+    return xmlHeader() +
+           "<styleSheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+           "<numFmts count=\"1\"><numFmt numFmtId=\"164\" formatCode=\"yyyy-mm-dd hh:mm\"/></numFmts>"
+           "<fonts count=\"2\"><font><sz val=\"11\"/><name val=\"Calibri\"/></font>"
+           "<font><b/><sz val=\"11\"/><name val=\"Calibri\"/></font></fonts>"
+           "<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill>"
+           "<fill><patternFill patternType=\"gray125\"/></fill></fills>"
+           "<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+           "<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+           "<cellXfs count=\"3\">"
+           "<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+           "<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/>"
+           "<xf numFmtId=\"164\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyNumberFormat=\"1\"/>"
+           "</cellXfs>"
+           "<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+           "</styleSheet>";
+}
+
+QByteArray sheetBegin(const QStringList &headers, const QList<int> &widths)
 {
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setOutputFileName(filePath);
-    printer.setPageMargins(QMarginsF(12, 12, 12, 12), QPageLayout::Millimeter);
+    QByteArray xml = xmlHeader() +
+                     "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+                     "<sheetViews><sheetView workbookViewId=\"0\">"
+                     "<pane ySplit=\"1\" topLeftCell=\"A2\" activePane=\"bottomLeft\" state=\"frozen\"/>"
+                     "</sheetView></sheetViews><cols>";
+    for (int i = 0; i < widths.size(); ++i) {
+        xml.append(QString("<col min=\"%1\" max=\"%1\" width=\"%2\" customWidth=\"1\"/>").arg(i + 1).arg(widths[i]).toUtf8());
+    }
+    xml.append("</cols><sheetData><row r=\"1\">");
+    for (int i = 0; i < headers.size(); ++i) appendStringCell(xml, i, 1, headers[i], XlsxHeader);
+    xml.append("</row>");
+    return xml;
+}
 
-    QVariantMap stats = statModel->getOverviewStats(f);
-    QTextDocument doc;
+QByteArray sheetEnd()
+{
+    return "</sheetData></worksheet>";
+}
+
+}
+
+bool Exporter::exportToXlsx(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                            const std::function<bool(int, int)> &progress)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    int total = countTasks(db, f) + countInspirations(db, f);
 
-    auto pixmapToBase64 = [](const QPixmap &pix) {
-        QByteArray ba;
-        QBuffer buf(&ba);
-        pix.save(&buf, "PNG");
-        return QString("data:image/png;base64,") + ba.toBase64();
+    // ZIP 需要回填文件头，不能以文本模式打开
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    ZipWriter zip(&file);
+    bool ok = zip.beginEntry("[Content_Types].xml") && zip.write(xlsxContentTypes())
+              && zip.beginEntry("_rels/.rels") && zip.write(xlsxRootRels())
+              && zip.beginEntry("xl/workbook.xml") && zip.write(xlsxWorkbook())
+              && zip.beginEntry("xl/_rels/workbook.xml.rels") && zip.write(xlsxWorkbookRels())
+              && zip.beginEntry("xl/styles.xml") && zip.write(xlsxStyles());
+
+    // 时间写成 Excel 日期序列值，配合日期样式显示
+    const QString excelTime = "julianday(%1) - 2415018.5";
+    int done = 0;
+    QByteArray buffer;
+    buffer.reserve(kXlsxFlushSize * 2);
+
+    // 行缓冲攒够一段再写入 ZIP，缓冲区容量复用
+    auto flushRow = [&]() {
+        if (ok && buffer.size() >= kXlsxFlushSize) {
+            ok = zip.write(buffer);
+            buffer.resize(0);
+        }
+        if (ok && ++done % 1000 == 0 && progress && !progress(done, total)) ok = false;
     };
 
-    const int IMG_FULL_WIDTH = 490;
-    const int IMG_HALF_WIDTH = 230;
-
-    QString html = "<html><head><style>"
-                   "body { font-family: 'Microsoft YaHei', sans-serif; }"
-                   "h1 { color: #2c3e50; text-align: center; margin-bottom: 5px; font-size: 16pt; }"
-                   "p.subtitle { text-align: center; color: #7f8c8d; font-size: 9pt; margin-top: 0; margin-bottom: 10px; }"
-                   "h2 { color: #34495e; border-left: 5px solid #657896; padding-left: 8px; margin-top: 10px; margin-bottom: 5px; font-size: 12pt; }"
-                   "table { width: 100%; border-collapse: collapse; }"
-                   "th, td { padding: 3px; }"
-                   ".stat-box { font-family: monospace; font-size: 9pt;padding: 6px; border-radius: 4px; }"
-                   "</style></head><body>";
-
-    html += "<h1>个人工作统计报表</h1>";
-    html += QString("<p class='subtitle'>统计周期: %1 至 %2</p>")
-                .arg(f.start.toString("yyyy-MM-dd")).arg(f.end.toString("yyyy-MM-dd"));
-
-    html += "<h2>1. 核心数据概览</h2>";
-    html += "<div class='stat-box'>";
-    html += "<table width='100%'>";
-    html += "<tr>"
-            "<td width='33%' style='text-align: left;'>任务总数: <b>" + stats["total"].toString() + "</b></td>"
-                                          "<td width='34%' style='text-align: center;'>已完成: <b style='color:#27ae60'>" + stats["completed"].toString() + "</b></td>"
-                                              "<td width='33%' style='text-align: right;'>完成率: <b>" + QString::number(stats["rate"].toDouble(), 'f', 1) + "%</b></td>"
-                                                                  "</tr>";
-
-    html += "<tr>"
-            "<td width='33%' style='text-align: left;'>已逾期: <b style='color:#c0392b'>" + stats["overdue"].toString() + "</b></td>"
-                                            "<td width='34%' style='text-align: center;'>平均耗时: <b>" + QString::number(statModel->getAverageCompletionTime(f), 'f', 1) + "h</b></td>"
-                                                                                "<td width='33%' style='text-align: right;'>产生灵感: <b>" + QString::number(statModel->getInspirationCount(f)) + "</b></td>"
-                                                                   "</tr>";
-    html += "</table></div>";
-
-    if (chartPixmaps.size() >= 4) {
-        html += "<h2>2. 可视化分析</h2>";
-        html += "<table border='0' cellspacing='0' cellpadding='0' style='margin-bottom: 5px;'><tr>";
-        html += "<td width='50%' valign='top' align='center'>";
-        html += QString("<img src='%1' width='%2'>").arg(pixmapToBase64(chartPixmaps[0])).arg(IMG_HALF_WIDTH);
-        html += "</td>";
-        html += "<td width='50%' valign='top' style='padding-left: 8px;'>";
-        html += "<div style='background-color: #f0f4f8; border: 1px solid #dce4ec; border-radius: 6px; padding: 6px; text-align: left;'>";
-        html += "<div style='color: #657896; font-weight: bold; font-size: 9pt; border-bottom: 1px solid #dce4ec; padding-bottom: 2px; margin-bottom: 2px;'>✨ AI 智能分析建议</div>";
-
-        QString processedAiText = aiAnalysisText;
-        processedAiText.replace("\n", "<br>");
-        if(processedAiText.isEmpty()) processedAiText = "<span style='color:#95a5a6; font-style:italic; font-size: 8pt;'>暂无分析内容。</span>";
-
-        html += "<div style='font-size: 8pt; line-height: 1.2; color: #2c3e50;'>" + processedAiText + "</div>";
-        html += "</div>";
-        html += "</td>";
-        html += "</tr></table>";
-        html += "<div align='center' style='margin-bottom: 5px; border: 1px solid #eee; padding: 2px; border-radius: 4px;'>";
-        html += QString("<img src='%1' width='%2'>").arg(pixmapToBase64(chartPixmaps[1])).arg(IMG_FULL_WIDTH);
-        html += "</div>";
-
-        html += "<table border='0' cellspacing='0' cellpadding='0'><tr>";
-        html += "<td width='50%' align='center'>";
-        html += QString("<img src='%1' width='%2'>").arg(pixmapToBase64(chartPixmaps[2])).arg(IMG_HALF_WIDTH);
-        html += "</td>";
-        html += "<td width='50%' align='center'>";
-        html += QString("<img src='%1' width='%2'>").arg(pixmapToBase64(chartPixmaps[3])).arg(IMG_HALF_WIDTH);
-        html += "</td>";
-        html += "</tr></table>";
-    }
-
-    html += "<h2 style='page-break-before: always; margin-top: 20px;'>3. 任务清单详情</h2>";
-
-    html += "<table border='1' cellspacing='0' cellpadding='2' "
-            "style='border-color: #bdc3c7; font-size: 8pt;'>";
-
-    html += "<tr style='background-color: #657896; color: white;'>"
-            "<th width='30%'>标题</th>"
-            "<th width='15%' style='white-space: nowrap;'>分类</th>"
-            "<th width='10%' style='white-space: nowrap;'>状态</th>"
-            "<th width='15%' style='white-space: nowrap;'>创建日期</th>"
-            "<th width='15%' style='white-space: nowrap;'>完成日期</th>"
-            "<th width='15%' style='white-space: nowrap;'>截止日期</th>"
-            "</tr>";
-
-    QList<QVariantMap> allTasks = taskModel->getAllTasks(false);
-    int rowCount = 0;
+    QSqlQuery q(db);
+    if (ok) {
+        ok = zip.beginEntry("xl/worksheets/sheet1.xml")
+             && zip.write(sheetBegin({"ID", "标题", "描述", "分类", "标签", "优先级", "状态",
+                                      "开始时间", "截止时间", "提醒时间", "创建时间", "更新时间", "完成时间"},
+                                     {8, 30, 40, 12, 20, 8, 8, 17, 17, 17, 17, 17, 17}))
+             && execTaskQuery(q, "t.id, t.title, t.description, c.name, " + tagListExpr("', '", f) + ", "
+                                 + priorityNameExpr() + ", " + statusNameExpr() + ", "
+                                 + excelTime.arg("t.start_time") + ", " + excelTime.arg("t.deadline") + ", "
+                                 + excelTime.arg("t.remind_time") + ", " + excelTime.arg("t.created_at") + ", "
+                                 + excelTime.arg("t.updated_at") + ", " + excelTime.arg("t.completed_at"), f);
+    }
+    int row = 1;
+    while (ok && q.next()) {
+        if (row >= kSheetRowLimit) {
+            qDebug() << "任务数超过工作表行数上限，其余行未导出";
+            break;
+        }
+        ++row;
+        buffer.append("<row r=\"").append(QByteArray::number(row)).append("\">");
+        appendNumberCell(buffer, 0, row, q.value(0));
+        for (int i = 1; i <= 6; ++i) appendStringCell(buffer, i, row, q.value(i));
+        for (int i = 7; i <= 12; ++i) appendNumberCell(buffer, i, row, q.value(i), XlsxDateTime);
+        buffer.append("</row>");
+        flushRow();
+    }
+    if (ok) {
+        buffer.append(sheetEnd());
+        ok = zip.write(buffer);
+        buffer.resize(0);
+    }
+
+    if (ok) {
+        q = QSqlQuery(db);
+        ok = zip.beginEntry("xl/worksheets/sheet2.xml")
+             && zip.write(sheetBegin({"ID", "内容", "标签", "创建时间", "更新时间"}, {8, 60, 20, 17, 17}))
+             && execInspirationQuery(q, "id, content, tags, " + excelTime.arg("created_at") + ", "
+                                        + excelTime.arg("updated_at"), f);
+    }
+    row = 1;
+    while (ok && q.next()) {
+        if (row >= kSheetRowLimit) {
+            qDebug() << "灵感数超过工作表行数上限，其余行未导出";
+            break;
+        }
+        ++row;
+        buffer.append("<row r=\"").append(QByteArray::number(row)).append("\">");
+        appendNumberCell(buffer, 0, row, q.value(0));
+        appendStringCell(buffer, 1, row, q.value(1));
+        appendStringCell(buffer, 2, row, q.value(2));
+        appendNumberCell(buffer, 3, row, q.value(3), XlsxDateTime);
+        appendNumberCell(buffer, 4, row, q.value(4), XlsxDateTime);
+        buffer.append("</row>");
+        flushRow();
+    }
+    if (ok) {
+        buffer.append(sheetEnd());
+        ok = zip.write(buffer) && zip.finish();
+    }
+    if (ok && progress) ok = progress(done, qMax(total, done));
+
+    file.close();
+    if (!ok) file.remove();
+    return ok;
+}
+
+Exporter::ChartPicture Exporter::recordChart(const SimpleChartWidget *chart)
+{
+    // 按界面上当前的尺寸录制，导出的图表与屏幕所见比例一致
+    ChartPicture result;
+    result.size = (chart->width() > 0 && chart->height() > 0) ? QSizeF(chart->size()) : QSizeF(600, 300);
+
+    QPainter painter(&result.picture);
+    chart->render(painter, QRectF(QPointF(0, 0), result.size), ThemePalette::printChartTheme());
+    painter.end();
+    return result;
+}
+
+namespace {
+
+// 报表绘制位置：坐标单位为 pt，原点在页边距内的左上角
+struct ReportCursor {
+    QPdfWriter *writer;
+    QPainter *painter;
+    QSizeF area;    // 可绘制区域，底部已扣除页码栏
+    qreal footer;
+    qreal y;
+    int page;
+};
 
-    for (const QVariantMap &task : allTasks) {
-        QDateTime dl = task["deadline"].toDateTime();
-        if (dl < f.start || dl > f.end) continue;
-        if (!f.categoryIds.isEmpty() && !f.categoryIds.contains(task["category_id"].toInt())) continue;
+const QColor kTextColor("#2c3e50");
+const QColor kMutedColor("#95a5a6");
+const QColor kAccentColor("#657896");
 
-        int s = task["status"].toInt();
-        QString sText = (s==0?"待办": (s==1?"进行中": (s==2?"已完成":"已延期")));
-        QString sColor = (s==0?"#e67e22": (s==1?"#3498db": (s==2?"#27ae60":"#c0392b")));
+void setReportFont(QPainter &painter, qreal pointSize, bool bold)
+{
+    // 坐标已缩放到 pt，字号需抵消设备分辨率
+    QFont font = painter.font();
+    font.setPointSizeF(pointSize * 72.0 / qMax(1, painter.device()->logicalDpiY()));
+    font.setBold(bold);
+    painter.setFont(font);
+}
+
+void resetPageTransform(ReportCursor &c)
+{
+    qreal scale = c.writer->resolution() / 72.0;
+    c.painter->resetTransform();
+    c.painter->scale(scale, scale);
+}
 
-        QString catName = task["category_name"].toString();
-        if (catName.isEmpty()) catName = "未分类";
+void finishPage(ReportCursor &c)
+{
+    QPainter &painter = *c.painter;
+    setReportFont(painter, 8, false);
+    painter.setPen(kMutedColor);
+    painter.drawText(QRectF(0, c.area.height(), c.area.width(), c.footer),
+                     Qt::AlignHCenter | Qt::AlignBottom, QString("第 %1 页").arg(c.page));
+}
+
+void newPage(ReportCursor &c)
+{
+    finishPage(c);
+    c.writer->newPage();
+    resetPageTransform(c);
+    c.y = 0;
+    c.page++;
+}
 
-        QString createStr = task["created_at"].toDateTime().toString("yyyy-MM-dd");
-        QDateTime compAt = task["completed_at"].toDateTime();
-        QString compStr = compAt.isValid() ? compAt.toString("yyyy-MM-dd") : "-";
+// 剩余空间不够时换页，返回是否换了页
+bool ensureSpace(ReportCursor &c, qreal height)
+{
+    if (c.y > 0 && c.y + height > c.area.height()) {
+        newPage(c);
+        return true;
+    }
+    return false;
+}
 
-        QString bgColor = (rowCount % 2 == 0) ? "#ffffff" : "#f2f6f8";
+void drawSectionTitle(ReportCursor &c, const QString &title)
+{
+    ensureSpace(c, 40);
+    QPainter &painter = *c.painter;
+    c.y += 8;
+    painter.fillRect(QRectF(0, c.y, 4, 18), kAccentColor);
+    setReportFont(painter, 12, true);
+    painter.setPen(QColor("#34495e"));
+    painter.drawText(QRectF(10, c.y, c.area.width() - 10, 18), Qt::AlignLeft | Qt::AlignVCenter, title);
+    c.y += 24;
+}
 
-        html += QString("<tr style='background-color: %1;'>"
-                        "<td style='text-align: left;'>%2</td>"
-                        "<td>%3</td>"
-                        "<td style='color: %4; font-weight: bold;'>%5</td>"
-                        "<td>%6</td>"
-                        "<td>%7</td>"
-                        "<td>%8</td>"
-                        "</tr>")
-                    .arg(bgColor)
-                    .arg(task["title"].toString())
-                    .arg(catName)
-                    .arg(sColor)
-                    .arg(sText)
-                    .arg(createStr)
-                    .arg(compStr)
-                    .arg(dl.toString("yyyy-MM-dd"));
+qreal chartHeight(const Exporter::ChartPicture &chart, qreal width)
+{
+    if (chart.size.isEmpty()) return 0;
+    return chart.size.height() * width / chart.size.width();
+}
 
-        rowCount++;
+void drawChart(QPainter &painter, const Exporter::ChartPicture &chart, const QPointF &topLeft, qreal width)
+{
+    if (chart.size.isEmpty()) return;
+    qreal scale = width / chart.size.width();
+    painter.save();
+    painter.translate(topLeft);
+    painter.scale(scale, scale);
+    painter.drawPicture(QPointF(0, 0), chart.picture);
+    painter.restore();
+}
+
+// 标签为常规字体，数值加粗着色，按 align 在 cell 内排布
+void drawStat(QPainter &painter, const QRectF &cell, Qt::Alignment align,
+              const QString &label, const QString &value, const QColor &valueColor)
+{
+    setReportFont(painter, 9, true);
+    qreal valueWidth = painter.fontMetrics().horizontalAdvance(value);
+    setReportFont(painter, 9, false);
+    qreal labelWidth = painter.fontMetrics().horizontalAdvance(label);
+
+    qreal x = cell.left();
+    if (align & Qt::AlignHCenter) x = cell.center().x() - (labelWidth + valueWidth) / 2;
+    else if (align & Qt::AlignRight) x = cell.right() - labelWidth - valueWidth;
+
+    painter.setPen(kTextColor);
+    painter.drawText(QRectF(x, cell.top(), labelWidth, cell.height()), Qt::AlignLeft | Qt::AlignVCenter, label);
+    setReportFont(painter, 9, true);
+    painter.setPen(valueColor);
+    painter.drawText(QRectF(x + labelWidth, cell.top(), valueWidth, cell.height()), Qt::AlignLeft | Qt::AlignVCenter, value);
+}
+
+const qreal kColumnRatios[] = { 0.30, 0.15, 0.10, 0.15, 0.15, 0.15 };
+const int kColumnCount = 6;
+
+void drawTableHeader(ReportCursor &c)
+{
+    static const QStringList headers = {"标题", "分类", "状态", "创建日期", "完成日期", "截止日期"};
+    QPainter &painter = *c.painter;
+    setReportFont(painter, 8, true);
+
+    qreal x = 0;
+    for (int i = 0; i < kColumnCount; ++i) {
+        QRectF cell(x, c.y, c.area.width() * kColumnRatios[i], 16);
+        painter.fillRect(cell, kAccentColor);
+        painter.setPen(QColor("#bdc3c7"));
+        painter.drawRect(cell);
+        painter.setPen(Qt::white);
+        painter.drawText(cell, Qt::AlignCenter, headers.at(i));
+        x += cell.width();
     }
+    c.y += 16;
+}
 
-    html += "</table>";
+}
 
-    if (rowCount == 0) {
-        html += "<div style='text-align: center; padding: 20px; color: #95a5a6; font-size: 9pt;'>暂无任务记录</div>";
+bool Exporter::exportReportToPDF(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                 const QList<ChartPicture> &charts, const QString &aiAnalysisText,
+                                 const std::function<bool(int, int)> &progress)
+{
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    StatisticModel statModel;
+    statModel.setConnectionName(connectionName);
+
+    int total = countTasks(db, f);
+    QVariantMap stats = statModel.getOverviewStats(f);
+    double avgTime = statModel.getAverageCompletionTime(f);
+    int inspirationCount = statModel.getInspirationCount(f);
+
+    QPdfWriter writer(filePath);
+    writer.setPageSize(QPageSize(QPageSize::A4));
+    writer.setPageMargins(QMarginsF(12, 12, 12, 12), QPageLayout::Millimeter);
+    writer.setResolution(300);
+    writer.setTitle("个人工作统计报表");
+
+    QPainter painter;
+    if (!painter.begin(&writer)) return false;
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setFont(QFont("Microsoft YaHei"));
+
+    const qreal footer = 18;
+    QSizeF paintSize = writer.pageLayout().paintRect(QPageLayout::Point).size();
+    ReportCursor c{&writer, &painter, QSizeF(paintSize.width(), paintSize.height() - footer), footer, 0, 1};
+    resetPageTransform(c);
+    const qreal width = c.area.width();
+
+    // 标题
+    setReportFont(painter, 16, true);
+    painter.setPen(kTextColor);
+    painter.drawText(QRectF(0, c.y, width, 26), Qt::AlignCenter, "个人工作统计报表");
+    c.y += 26;
+    setReportFont(painter, 9, false);
+    painter.setPen(QColor("#7f8c8d"));
+    painter.drawText(QRectF(0, c.y, width, 14), Qt::AlignCenter,
+                     QString("统计周期: %1 至 %2").arg(f.start.toString("yyyy-MM-dd"), f.end.toString("yyyy-MM-dd")));
+    c.y += 20;
+
+    // 1. 核心数据概览
+    drawSectionTitle(c, "1. 核心数据概览");
+    qreal third = width / 3;
+    drawStat(painter, QRectF(0, c.y, third, 16), Qt::AlignLeft, "任务总数: ", stats["total"].toString(), kTextColor);
+    drawStat(painter, QRectF(third, c.y, third, 16), Qt::AlignHCenter, "已完成: ", stats["completed"].toString(), QColor("#27ae60"));
+    drawStat(painter, QRectF(third * 2, c.y, third, 16), Qt::AlignRight, "完成率: ",
+             QString::number(stats["rate"].toDouble(), 'f', 1) + "%", kTextColor);
+    c.y += 18;
+    drawStat(painter, QRectF(0, c.y, third, 16), Qt::AlignLeft, "已逾期: ", stats["overdue"].toString(), QColor("#c0392b"));
+    drawStat(painter, QRectF(third, c.y, third, 16), Qt::AlignHCenter, "平均耗时: ",
+             QString::number(avgTime, 'f', 1) + "h", kTextColor);
+    drawStat(painter, QRectF(third * 2, c.y, third, 16), Qt::AlignRight, "产生灵感: ",
+             QString::number(inspirationCount), kTextColor);
+    c.y += 24;
+
+    // 2. 可视化分析：第一行左图右 AI 建议，第二行趋势图通栏，第三行两张图并排
+    if (charts.size() >= 4) {
+        drawSectionTitle(c, "2. 可视化分析");
+        const qreal gap = 8;
+        const qreal half = (width - gap) / 2;
+
+        qreal rowHeight = chartHeight(charts[0], half);
+        ensureSpace(c, rowHeight);
+        drawChart(painter, charts[0], QPointF(0, c.y), half);
+
+        QRectF box(half + gap, c.y, half, qMin(qMax(rowHeight, 80.0), c.area.height() - c.y));
+        painter.setPen(QColor("#dce4ec"));
+        painter.setBrush(QColor("#f0f4f8"));
+        painter.drawRoundedRect(box, 6, 6);
+        painter.setBrush(Qt::NoBrush);
+
+        QRectF textRect = box.adjusted(6, 6, -6, -6);
+        setReportFont(painter, 9, true);
+        painter.setPen(kAccentColor);
+        painter.drawText(QRectF(textRect.left(), textRect.top(), textRect.width(), 14),
+                         Qt::AlignLeft | Qt::AlignVCenter, "✨ AI 智能分析建议");
+        painter.setPen(QColor("#dce4ec"));
+        painter.drawLine(QPointF(textRect.left(), textRect.top() + 16), QPointF(textRect.right(), textRect.top() + 16));
+        textRect.setTop(textRect.top() + 19);
+
+        if (aiAnalysisText.isEmpty()) {
+            setReportFont(painter, 8, false);
+            QFont font = painter.font();
+            font.setItalic(true);
+            painter.setFont(font);
+            painter.setPen(kMutedColor);
+            painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, "暂无分析内容。");
+        } else {
+            setReportFont(painter, 8, false);
+            painter.setPen(kTextColor);
+            painter.save();
+            painter.setClipRect(textRect);
+            painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap, aiAnalysisText);
+            painter.restore();
+        }
+        c.y += qMax(rowHeight, box.height()) + gap;
+
+        rowHeight = chartHeight(charts[1], width);
+        ensureSpace(c, rowHeight);
+        drawChart(painter, charts[1], QPointF(0, c.y), width);
+        c.y += rowHeight + gap;
+
+        rowHeight = qMax(chartHeight(charts[2], half), chartHeight(charts[3], half));
+        ensureSpace(c, rowHeight);
+        drawChart(painter, charts[2], QPointF(0, c.y), half);
+        drawChart(painter, charts[3], QPointF(half + gap, c.y), half);
+        c.y += rowHeight + gap;
     }
 
-    html += QString("<div style='margin-top: 15px; text-align: right; color: #95a5a6; font-size: 8pt;'>"
-                    "生成时间: %1 | 共 %2 条记录"
-                    "</div>")
-                .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
-                .arg(rowCount);
+    // 3. 任务清单：逐行查询逐行绘制，写满一页就换页并重画表头
+    newPage(c);
+    drawSectionTitle(c, "3. 任务清单详情");
+    drawTableHeader(c);
 
-    html += "</body></html>";
+    QSqlQuery q(db);
+    bool ok = execTaskQuery(q, "t.title, IFNULL(NULLIF(c.name, ''), '未分类'), IFNULL(t.status, 0), "
+                               "IFNULL(strftime('%Y-%m-%d', t.created_at), ''), "
+                               "IFNULL(strftime('%Y-%m-%d', t.completed_at), '-'), "
+                               "IFNULL(strftime('%Y-%m-%d', t.deadline), '')", f);
 
-    doc.setHtml(html);
-    QTextOption option;
-    option.setWrapMode(QTextOption::WordWrap);
-    doc.setDefaultTextOption(option);
-    doc.setPageSize(printer.pageRect(QPrinter::Point).size());
-    doc.print(&printer);
+    static const QStringList statusNames = {"待办", "进行中", "已完成", "已延期"};
+    static const QStringList statusColors = {"#e67e22", "#3498db", "#27ae60", "#c0392b"};
 
-    return true;
+    qreal columnX[kColumnCount + 1] = {0};
+    for (int i = 0; i < kColumnCount; ++i) columnX[i + 1] = columnX[i] + width * kColumnRatios[i];
+
+    int rowCount = 0;
+    while (ok && q.next()) {
+        setReportFont(painter, 8, false);
+        QString title = q.value(0).toString();
+        QRectF titleBounds = painter.boundingRect(QRectF(0, 0, columnX[1] - 6, 1000),
+                                                  Qt::AlignLeft | Qt::TextWordWrap, title);
+        qreal rowHeight = qMax<qreal>(14, titleBounds.height() + 4);
+
+        if (ensureSpace(c, rowHeight)) drawTableHeader(c);
+
+        QRectF rowRect(0, c.y, width, rowHeight);
+        painter.fillRect(rowRect, rowCount % 2 == 0 ? QColor("#ffffff") : QColor("#f2f6f8"));
+
+        setReportFont(painter, 8, false);
+        painter.setPen(kTextColor);
+        painter.drawText(QRectF(3, c.y + 2, columnX[1] - 6, rowHeight - 4), Qt::AlignLeft | Qt::AlignVCenter | Qt::TextWordWrap, title);
+        QString category = painter.fontMetrics().elidedText(q.value(1).toString(), Qt::ElideRight,
+                                                            qRound(columnX[2] - columnX[1] - 6));
+        painter.drawText(QRectF(columnX[1], c.y, columnX[2] - columnX[1], rowHeight), Qt::AlignCenter, category);
+        for (int i = 3; i < kColumnCount; ++i) {
+            painter.drawText(QRectF(columnX[i], c.y, columnX[i + 1] - columnX[i], rowHeight), Qt::AlignCenter, q.value(i).toString());
+        }
+
+        int status = qBound(0, q.value(2).toInt(), 3);
+        setReportFont(painter, 8, true);
+        painter.setPen(QColor(statusColors.at(status)));
+        painter.drawText(QRectF(columnX[2], c.y, columnX[3] - columnX[2], rowHeight), Qt::AlignCenter, statusNames.at(status));
+
+        painter.setPen(QColor("#bdc3c7"));
+        for (int i = 0; i <= kColumnCount; ++i) painter.drawLine(QPointF(columnX[i], c.y), QPointF(columnX[i], c.y + rowHeight));
+        painter.drawLine(QPointF(0, c.y + rowHeight), QPointF(width, c.y + rowHeight));
+
+        c.y += rowHeight;
+        if (++rowCount % 200 == 0 && progress && !progress(rowCount, total)) {
+            ok = false;
+            break;
+        }
+    }
+
+    if (ok) {
+        if (rowCount == 0) {
+            ensureSpace(c, 40);
+            setReportFont(painter, 9, false);
+            painter.setPen(kMutedColor);
+            painter.drawText(QRectF(0, c.y, width, 40), Qt::AlignCenter, "暂无任务记录");
+            c.y += 40;
+        }
+
+        ensureSpace(c, 24);
+        setReportFont(painter, 8, false);
+        painter.setPen(kMutedColor);
+        painter.drawText(QRectF(0, c.y + 10, width, 14), Qt::AlignRight | Qt::AlignVCenter,
+                         QString("生成时间: %1 | 共 %2 条记录")
+                             .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
+                             .arg(rowCount));
+        finishPage(c);
+        if (progress) ok = progress(rowCount, qMax(total, rowCount));
+    }
+
+    painter.end();
+    if (!ok) QFile::remove(filePath);
+    return ok;
 }
@@ -4,19 +4,37 @@
 #include <QString>
 #include <QList>
 #include <QVariantMap>
-#include <QPixmap>
+#include <QPicture>
+#include <QSizeF>
+#include <functional>
 #include "models/statisticmodel.h"
 
-class TaskModel;
+class SimpleChartWidget;
 
 class Exporter
 {
 public:
-    static bool exportTasksToCSV(const QString &filePath, TaskModel *model, const StatisticModel::Filter &f);
+    // 在 connectionName 对应的连接上流式导出；progress 返回 false 时中止并删除未写完的文件
+    static bool exportTasksToCSV(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                 const std::function<bool(int, int)> &progress = nullptr);
+    // 任务和灵感按行写成 JSON 对象，供其他工具读取
+    static bool exportToJsonLines(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                  const std::function<bool(int, int)> &progress = nullptr);
+    // 不依赖第三方库的 XLSX：工作表逐行写入不压缩的 ZIP 条目，任务和灵感各占一张表
+    static bool exportToXlsx(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                             const std::function<bool(int, int)> &progress = nullptr);
 
-    static bool exportReportToPDF(const QString &filePath, TaskModel *taskModel, StatisticModel *statModel,
-                                  const StatisticModel::Filter &f, const QList<QPixmap> &chartPixmaps,
-                                  const QString &aiAnalysisText);
+    // 图表必须在界面线程录制，之后可在导出线程中按矢量回放
+    struct ChartPicture {
+        QPicture picture;
+        QSizeF size;
+    };
+    static ChartPicture recordChart(const SimpleChartWidget *chart);
+
+    // 直接用 QPainter 分页绘制报表，任务清单逐行查询逐行绘制，可在导出线程中调用
+    static bool exportReportToPDF(const QString &filePath, const QString &connectionName, const StatisticModel::Filter &f,
+                                  const QList<ChartPicture> &charts, const QString &aiAnalysisText,
+                                  const std::function<bool(int, int)> &progress = nullptr);
 };
 
 #endif // EXPORTER_H
@@ -0,0 +1,478 @@
+#include "importer.h"
+#include "database/database.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QVector>
+#include <QThread>
+#include <QThreadPool>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+
+namespace {
+
+const qint64 kChunkSize = 4 * 1024 * 1024;
+// 每个事务最多写入的任务数，避免页缓存溢出后长时间持有排他锁挡住界面读写
+const int kCommitRows = 2000;
+
+enum Field {
+    FieldIgnored = -1,
+    FieldExternalId, FieldTitle, FieldDescription, FieldCategory, FieldTags, FieldPriority, FieldStatus,
+    FieldStartTime, FieldDeadline, FieldRemindTime, FieldCreatedAt, FieldCompletedAt
+};
+
+struct ImportRecord {
+    QString externalId;
+    QString title;
+    QString description;
+    QString category;
+    QStringList tags;
+    int priority = 2;
+    int status = 0;
+    QString startTime;
+    QString deadline;
+    QString remindTime;
+    QString createdAt;
+    QString completedAt;
+};
+
+struct ParsedChunk {
+    QVector<ImportRecord> records;
+    int failed = 0;
+};
+
+Field fieldForHeader(const QString &header)
+{
+    static const QHash<QString, Field> fields = {
+        // 本地自增的 id 只在来源数据库内唯一，不能作为去重用的外部编号
+        {"external_id", FieldExternalId}, {"外部编号", FieldExternalId},
+        {"title", FieldTitle}, {"标题", FieldTitle},
+        {"description", FieldDescription}, {"描述", FieldDescription},
+        {"category", FieldCategory}, {"分类", FieldCategory},
+        {"tags", FieldTags}, {"标签", FieldTags},
+        {"priority", FieldPriority}, {"优先级", FieldPriority},
+        {"status", FieldStatus}, {"状态", FieldStatus},
+        {"start_time", FieldStartTime}, {"开始时间", FieldStartTime},
+        {"deadline", FieldDeadline}, {"截止时间", FieldDeadline},
+        {"remind_time", FieldRemindTime}, {"提醒时间", FieldRemindTime},
+        {"created_at", FieldCreatedAt}, {"创建时间", FieldCreatedAt},
+        {"completed_at", FieldCompletedAt}, {"完成时间", FieldCompletedAt}
+    };
+    return fields.value(header.trimmed().toLower(), FieldIgnored);
+}
+
+int parsePriority(const QString &text)
+{
+    static const QHash<QString, int> names = {{"紧急", 0}, {"重要", 1}, {"普通", 2}, {"不急", 3}};
+    bool ok = false;
+    int value = text.toInt(&ok);
+    if (ok) return qBound(0, value, 3);
+    return names.value(text.trimmed(), 2);
+}
+
+int parseStatus(const QString &text)
+{
+    static const QHash<QString, int> names = {{"待办", 0}, {"进行中", 1}, {"已完成", 2}, {"已延期", 3}};
+    bool ok = false;
+    int value = text.toInt(&ok);
+    if (ok) return qBound(0, value, 3);
+    return names.value(text.trimmed(), 0);
+}
+
+// 统一成与 QDateTime 绑定时相同的 ISO 文本，只做字符串整理，不逐行构造 QDateTime
+QString normalizeTime(const QString &text)
+{
+    QString value = text.trimmed();
+    if (value.isEmpty() || value == "-") return QString();
+    if (value.size() >= 11 && value.at(10) == ' ') value[10] = 'T';
+    if (value.size() == 10) value += "T00:00";
+    if (value.size() == 16) value += ":00";
+    if (value.size() == 19) value += ".000";
+    return value;
+}
+
+QStringList splitTags(const QString &text)
+{
+    QStringList tags;
+    for (const QString &tag : text.split(QRegularExpression("[,;，；]"), Qt::SkipEmptyParts)) {
+        QString name = tag.trimmed();
+        if (!name.isEmpty()) tags << name;
+    }
+    return tags;
+}
+
+void setField(ImportRecord &record, Field field, const QString &value)
+{
+    switch (field) {
+    case FieldExternalId: record.externalId = value.trimmed(); break;
+    case FieldTitle: record.title = value.trimmed(); break;
+    case FieldDescription: record.description = value; break;
+    case FieldCategory: record.category = value.trimmed(); break;
+    case FieldTags: record.tags = splitTags(value); break;
+    case FieldPriority: record.priority = parsePriority(value); break;
+    case FieldStatus: record.status = parseStatus(value); break;
+    case FieldStartTime: record.startTime = normalizeTime(value); break;
+    case FieldDeadline: record.deadline = normalizeTime(value); break;
+    case FieldRemindTime: record.remindTime = normalizeTime(value); break;
+    case FieldCreatedAt: record.createdAt = normalizeTime(value); break;
+    case FieldCompletedAt: record.completedAt = normalizeTime(value); break;
+    case FieldIgnored: break;
+    }
+}
+
+// 解析一条 CSV 记录（可跨行），pos 移到下一条记录开头
+QStringList parseCsvRecord(const QByteArray &data, qint64 &pos)
+{
+    QStringList fields;
+    QByteArray field;
+    bool inQuotes = false;
+    const qint64 size = data.size();
+
+    while (pos < size) {
+        char ch = data.at(pos++);
+        if (inQuotes) {
+            if (ch == '"') {
+                if (pos < size && data.at(pos) == '"') {
+                    field.append('"');
+                    ++pos;
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                field.append(ch);
+            }
+        } else if (ch == '"') {
+            inQuotes = true;
+        } else if (ch == ',') {
+            fields << QString::fromUtf8(field);
+            field.resize(0);
+        } else if (ch == '\n') {
+            break;
+        } else if (ch != '\r') {
+            field.append(ch);
+        }
+    }
+    fields << QString::fromUtf8(field);
+    return fields;
+}
+
+ParsedChunk parseCsvChunk(const QByteArray &data, const QVector<Field> &columns)
+{
+    ParsedChunk chunk;
+    qint64 pos = 0;
+    while (pos < data.size()) {
+        QStringList values = parseCsvRecord(data, pos);
+        if (values.size() == 1 && values.first().trimmed().isEmpty()) continue;
+
+        ImportRecord record;
+        for (int i = 0; i < values.size() && i < columns.size(); ++i) setField(record, columns[i], values[i]);
+        if (record.title.isEmpty()) {
+            chunk.failed++;
+            continue;
+        }
+        chunk.records.append(record);
+    }
+    return chunk;
+}
+
+QString jsonText(const QJsonValue &value)
+{
+    if (value.isDouble()) return QString::number(value.toInteger());
+    return value.toString();
+}
+
+ParsedChunk parseJsonChunk(const QByteArray &data)
+{
+    ParsedChunk chunk;
+    qint64 pos = 0;
+    while (pos < data.size()) {
+        qint64 end = data.indexOf('\n', pos);
+        if (end < 0) end = data.size();
+        QByteArray line = data.mid(pos, end - pos).trimmed();
+        pos = end + 1;
+        if (line.isEmpty()) continue;
+
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+            chunk.failed++;
+            continue;
+        }
+
+        QJsonObject obj = doc.object();
+        if (obj.contains("type") && obj.value("type").toString() != "task") continue;
+
+        ImportRecord record;
+        record.externalId = jsonText(obj.value("external_id")).trimmed();
+        record.title = obj.value("title").toString().trimmed();
+        record.description = obj.value("description").toString();
+        record.category = obj.value("category").toString().trimmed();
+
+        QJsonValue tags = obj.value("tags");
+        if (tags.isArray()) {
+            for (const QJsonValue &tag : tags.toArray()) {
+                QString name = tag.toString().trimmed();
+                if (!name.isEmpty()) record.tags << name;
+            }
+        } else {
+            record.tags = splitTags(tags.toString());
+        }
+
+        record.priority = obj.contains("priority") ? parsePriority(jsonText(obj.value("priority"))) : 2;
+        record.status = obj.contains("status") ? parseStatus(jsonText(obj.value("status"))) : 0;
+        record.startTime = normalizeTime(obj.value("start_time").toString());
+        record.deadline = normalizeTime(obj.value("deadline").toString());
+        record.remindTime = normalizeTime(obj.value("remind_time").toString());
+        record.createdAt = normalizeTime(obj.value("created_at").toString());
+        record.completedAt = normalizeTime(obj.value("completed_at").toString());
+
+        if (record.title.isEmpty()) {
+            chunk.failed++;
+            continue;
+        }
+        chunk.records.append(record);
+    }
+    return chunk;
+}
+
+// 在 data 中找最后一个可以切分的位置（不在引号内的换行之后），找不到返回 -1
+// 切分点总在引号外，所以每块都从引号外开始扫描
+qint64 lastRecordBoundary(const QByteArray &data, bool csv)
+{
+    if (!csv) {
+        qint64 pos = data.lastIndexOf('\n');
+        return pos < 0 ? -1 : pos + 1;
+    }
+
+    qint64 boundary = -1;
+    bool quoted = false;
+    const char *p = data.constData();
+    for (qint64 i = 0; i < data.size(); ++i) {
+        if (p[i] == '"') quoted = !quoted;
+        else if (p[i] == '\n' && !quoted) boundary = i + 1;
+    }
+    return boundary;
+}
+
+QVariant nullable(const QString &value)
+{
+    return value.isEmpty() ? QVariant() : QVariant(value);
+}
+
+// 名称到编号的内存字典，缺失时插入新行
+class NameResolver
+{
+public:
+    NameResolver(QSqlDatabase db, const QString &table, const QString &insertSql)
+        : m_insert(db)
+    {
+        QSqlQuery q(db);
+        if (q.exec(QString("SELECT id, name FROM %1").arg(table))) {
+            while (q.next()) m_ids.insert(q.value(1).toString(), q.value(0).toInt());
+        }
+        m_insert.prepare(insertSql);
+    }
+
+    bool contains(const QString &name) const
+    {
+        return m_ids.contains(name);
+    }
+
+    QVariant resolve(const QString &name)
+    {
+        if (name.isEmpty()) return QVariant();
+        auto it = m_ids.constFind(name);
+        if (it != m_ids.constEnd()) return it.value();
+
+        m_insert.bindValue(0, name);
+        if (!m_insert.exec()) {
+            qDebug() << "导入时新建名称失败:" << name << m_insert.lastError().text();
+            return QVariant();
+        }
+        int id = m_insert.lastInsertId().toInt();
+        m_ids.insert(name, id);
+        return id;
+    }
+
+private:
+    QHash<QString, int> m_ids;
+    QSqlQuery m_insert;
+};
+
+}
+
+bool Importer::importTasks(const QString &filePath, const QString &connectionName, Result &result,
+                           const std::function<bool(qint64, qint64)> &progress)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const bool csv = QFileInfo(filePath).suffix().compare("csv", Qt::CaseInsensitive) == 0;
+    const qint64 totalBytes = file.size();
+
+    QSqlDatabase db = QSqlDatabase::database(connectionName);
+    NameResolver categories(db, "task_categories",
+                            "INSERT INTO task_categories (name, color, is_custom) VALUES (?, '#657896', 1)");
+    NameResolver tags(db, "task_tags", "INSERT INTO task_tags (name, color) VALUES (?, '#657896')");
+
+    // 语句只准备一次，逐行重新绑定；外部编号重复的行由唯一索引忽略
+    QSqlQuery insertTask(db);
+    insertTask.prepare("INSERT OR IGNORE INTO tasks (external_id, title, description, category_id, priority, status, "
+                       "start_time, deadline, remind_time, created_at, updated_at, completed_at) "
+                       "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    QSqlQuery insertRelation(db);
+    insertRelation.prepare("INSERT OR IGNORE INTO task_tag_relations (task_id, tag_id) VALUES (?, ?)");
+
+    // 本库导出的任务外部编号为“数据库编号:任务 id”，导回本库时对应任务仍在则视为重复
+    QString localPrefix;
+    QSqlQuery uuidQuery(db);
+    if (uuidQuery.exec("SELECT value FROM user_settings WHERE key = 'database_uuid'") && uuidQuery.next()) {
+        localPrefix = uuidQuery.value(0).toString() + ":";
+    }
+    // 唯一索引只在主库上；连接附加了归档库时，外部编号和本库任务 id 也要在归档库中查
+    QSqlQuery archivedExternal(db);
+    const bool archiveAttached = archivedExternal.prepare("SELECT 1 FROM archive.tasks WHERE external_id = ?");
+    QSqlQuery localTask(db);
+    localTask.prepare(archiveAttached ? "SELECT 1 FROM tasks WHERE id = ? UNION ALL SELECT 1 FROM archive.tasks WHERE id = ?"
+                                      : "SELECT 1 FROM tasks WHERE id = ?");
+    auto isKnownTask = [&](const QString &externalId) {
+        if (externalId.isEmpty()) return false;
+        if (archiveAttached) {
+            archivedExternal.bindValue(0, externalId);
+            if (archivedExternal.exec() && archivedExternal.next()) return true;
+        }
+        if (localPrefix.size() <= 1 || !externalId.startsWith(localPrefix)) return false;
+        int id = externalId.mid(localPrefix.size()).toInt();
+        localTask.bindValue(0, id);
+        if (archiveAttached) localTask.bindValue(1, id);
+        return localTask.exec() && localTask.next();
+    };
+
+    int pendingRows = 0;
+    auto commitRows = [&]() {
+        if (!db.commit()) {
+            qDebug() << "导入提交失败:" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        pendingRows = 0;
+        Database::instance().markDataChanged();
+        return true;
+    };
+
+    QVector<Field> columns;
+    QByteArray pending;
+    bool headerRead = !csv;
+    bool ok = true;
+
+    const int threadCount = qMax(1, QThread::idealThreadCount());
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+
+    while (ok && (!file.atEnd() || !pending.isEmpty())) {
+        // 每批读入若干块，按记录边界切开后并行解析
+        QVector<QByteArray> chunks;
+        while (chunks.size() < threadCount && !file.atEnd()) {
+            QByteArray data = pending + file.read(kChunkSize);
+            pending.clear();
+
+            if (!headerRead) {
+                if (data.startsWith("\xEF\xBB\xBF")) data.remove(0, 3);
+                qint64 pos = 0;
+                for (const QString &header : parseCsvRecord(data, pos)) columns << fieldForHeader(header);
+                data.remove(0, pos);
+                headerRead = true;
+            }
+
+            qint64 boundary = file.atEnd() ? data.size() : lastRecordBoundary(data, csv);
+            if (boundary < 0) {
+                // 单条记录超过一块，继续拼接
+                pending = data;
+                continue;
+            }
+            pending = data.mid(boundary);
+            data.truncate(boundary);
+            chunks.append(data);
+        }
+        if (file.atEnd() && !pending.isEmpty()) {
+            chunks.append(pending);
+            pending.clear();
+        }
+        if (chunks.isEmpty()) continue;
+
+        QVector<ParsedChunk> parsed(chunks.size());
+        for (int i = 0; i < chunks.size(); ++i) {
+            pool.start([&, i]() {
+                parsed[i] = csv ? parseCsvChunk(chunks[i], columns) : parseJsonChunk(chunks[i]);
+            });
+        }
+        pool.waitForDone();
+        chunks.clear();
+
+        QString now = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+        db.transaction();
+        for (const ParsedChunk &chunk : parsed) {
+            result.failed += chunk.failed;
+            for (const ImportRecord &record : chunk.records) {
+                if (pendingRows >= kCommitRows) {
+                    if (!commitRows()) return false;
+                    db.transaction();
+                }
+                ++pendingRows;
+
+                if (isKnownTask(record.externalId)) {
+                    result.duplicates++;
+                    continue;
+                }
+
+                insertTask.bindValue(0, nullable(record.externalId));
+                insertTask.bindValue(1, record.title);
+                insertTask.bindValue(2, record.description);
+                // 导出时无分类写作“未分类”，导回时不据此新建分类
+                bool uncategorized = record.category == "未分类" && !categories.contains(record.category);
+                insertTask.bindValue(3, uncategorized ? QVariant() : categories.resolve(record.category));
+                insertTask.bindValue(4, record.priority);
+                insertTask.bindValue(5, record.status);
+                insertTask.bindValue(6, nullable(record.startTime));
+                insertTask.bindValue(7, nullable(record.deadline));
+                insertTask.bindValue(8, nullable(record.remindTime));
+                insertTask.bindValue(9, record.createdAt.isEmpty() ? now : record.createdAt);
+                insertTask.bindValue(10, now);
+                insertTask.bindValue(11, nullable(record.completedAt));
+
+                if (!insertTask.exec()) {
+                    qDebug() << "导入任务失败:" << insertTask.lastError().text();
+                    result.failed++;
+                    continue;
+                }
+                if (insertTask.numRowsAffected() == 0) {
+                    result.duplicates++;
+                    continue;
+                }
+
+                result.imported++;
+                QVariant taskId = insertTask.lastInsertId();
+                for (const QString &tag : record.tags) {
+                    QVariant tagId = tags.resolve(tag);
+                    if (tagId.isNull()) continue;
+                    insertRelation.bindValue(0, taskId);
+                    insertRelation.bindValue(1, tagId);
+                    insertRelation.exec();
+                }
+            }
+        }
+
+        if (!commitRows()) return false;
+
+        if (progress && !progress(file.pos() - pending.size(), totalBytes)) ok = false;
+    }
+
+    return ok;
+}
@@ -0,0 +1,24 @@
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <QString>
+#include <functional>
+
+// 批量导入任务：文件按块切分后多线程解析，再在同一连接上按固定行数分批事务写入
+// 支持 CSV（表头按列名识别，兼容本程序导出的格式）和 JSON Lines（只导入 type 为 task 的行）
+class Importer
+{
+public:
+    struct Result {
+        int imported = 0;
+        int duplicates = 0;   // 外部编号已存在（包括归档库），或本库导出的任务仍在而跳过的行
+        int failed = 0;       // 无法解析或缺少标题的行
+    };
+
+    // progress 参数为已处理字节数和文件总字节数；返回 false 时在当前批次提交后停止，
+    // 已提交的批次保留，重新导入同一文件时按外部编号跳过
+    static bool importTasks(const QString &filePath, const QString &connectionName, Result &result,
+                            const std::function<bool(qint64, qint64)> &progress = nullptr);
+};
+
+#endif // IMPORTER_H
@@ -0,0 +1,140 @@
+#include "stylesheetengine.h"
+#include <QFile>
+#include <QDebug>
+
+static const char *const kTokenNames[] = {
+    "@BG_MAIN@", "@BG_SUB@", "@BG_INPUT@", "@BORDER@", "@TEXT_MAIN@", "@TEXT_SUB@", "@ICON_ARROW@",
+    "@THEME@", "@THEME_HOVER@", "@THEME_PRESSED@", "@THEME_SELECTION@"
+};
+
+StyleSheetEngine& StyleSheetEngine::instance()
+{
+    static StyleSheetEngine instance;
+    return instance;
+}
+
+StyleSheetEngine::StyleSheetEngine()
+    : m_literalLength(0)
+{
+    QString source;
+    QFile file(":/styles/mainwindow.qss");
+    if (file.open(QFile::ReadOnly | QFile::Text)) {
+        source = QString::fromUtf8(file.readAll());
+        file.close();
+    } else {
+        qDebug() << "无法读取样式表文件:" << file.fileName();
+    }
+
+    compile(source);
+}
+
+void StyleSheetEngine::compile(const QString &source)
+{
+    m_segments.clear();
+    m_literalLength = 0;
+
+    QString literal;
+    int pos = 0;
+
+    while (pos < source.size()) {
+        int start = source.indexOf('@', pos);
+        if (start < 0) {
+            literal += QStringView(source).mid(pos);
+            break;
+        }
+
+        literal += QStringView(source).mid(pos, start - pos);
+
+        int token = -1;
+        int end = source.indexOf('@', start + 1);
+        if (end > start) {
+            QStringView name = QStringView(source).mid(start, end - start + 1);
+            for (int i = 0; i < TokenCount; ++i) {
+                if (name.compare(QLatin1String(kTokenNames[i]), Qt::CaseInsensitive) == 0) {
+                    token = i;
+                    break;
+                }
+            }
+        }
+
+        if (token < 0) {
+            // 不是占位符，'@' 按普通字符保留
+            literal += QLatin1Char('@');
+            pos = start + 1;
+            continue;
+        }
+
+        if (!literal.isEmpty()) {
+            m_literalLength += literal.size();
+            m_segments.append({literal, -1});
+            literal.clear();
+        }
+        m_segments.append({QString(), token});
+        pos = end + 1;
+    }
+
+    if (!literal.isEmpty()) {
+        m_literalLength += literal.size();
+        m_segments.append({literal, -1});
+    }
+}
+
+QString StyleSheetEngine::variantKey(bool isLight, const QColor &theme)
+{
+    return QString("%1%2").arg(isLight ? "light" : "dark", theme.name());
+}
+
+QString StyleSheetEngine::styleSheet(bool isLight, const QColor &theme)
+{
+    QString key = variantKey(isLight, theme);
+    auto it = m_variants.constFind(key);
+    if (it != m_variants.constEnd()) {
+        return it.value();
+    }
+
+    QString sheet = render(tokenValues(isLight, theme));
+    m_variants.insert(key, sheet);
+    return sheet;
+}
+
+QStringList StyleSheetEngine::tokenValues(bool isLight, const QColor &theme) const
+{
+    QStringList values;
+    values.reserve(TokenCount);
+
+    if (isLight) {
+        // --- 浅色模式 ---
+        values << "#f5f7fa" << "#ffffff" << "#ffffff" << "#dcdfe6"
+               << "#303133" << "#909399" << ":/icons/dark_down.png";
+    } else {
+        // --- 深色模式 ---
+        values << "#303030" << "#454545" << "#383838" << "#555555"
+               << "#ffffff" << "#cccccc" << ":/icons/light_down.png";
+    }
+
+    values << theme.name()
+           << theme.lighter(115).name()
+           << theme.darker(110).name()
+           << QString("rgba(%1, %2, %3, %4)")
+                  .arg(theme.red())
+                  .arg(theme.green())
+                  .arg(theme.blue())
+                  .arg(isLight ? 40 : 60);
+
+    return values;
+}
+
+QString StyleSheetEngine::render(const QStringList &values) const
+{
+    QString result;
+    result.reserve(m_literalLength + m_segments.size() * 24);
+
+    for (const Segment &segment : m_segments) {
+        if (segment.token < 0) {
+            result += segment.text;
+        } else {
+            result += values.at(segment.token);
+        }
+    }
+    return result;
+}
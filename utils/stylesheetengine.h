@@ -0,0 +1,43 @@
+#ifndef STYLESHEETENGINE_H
+#define STYLESHEETENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QColor>
+
+// 样式表模板只解析一次，记录每个 @TOKEN@ 的位置；各 (主题色, 明暗) 组合生成后缓存复用
+class StyleSheetEngine
+{
+public:
+    static StyleSheetEngine& instance();
+
+    QString styleSheet(bool isLight, const QColor &theme);
+    static QString variantKey(bool isLight, const QColor &theme);
+
+private:
+    StyleSheetEngine();
+    StyleSheetEngine(const StyleSheetEngine&) = delete;
+    StyleSheetEngine& operator=(const StyleSheetEngine&) = delete;
+
+    enum Token {
+        BgMain, BgSub, BgInput, Border, TextMain, TextSub, IconArrow,
+        Theme, ThemeHover, ThemePressed, ThemeSelection, TokenCount
+    };
+
+    struct Segment {
+        QString text;
+        int token;      // -1 表示普通文本
+    };
+
+    QVector<Segment> m_segments;
+    int m_literalLength;
+    QHash<QString, QString> m_variants;
+
+    void compile(const QString &source);
+    QStringList tokenValues(bool isLight, const QColor &theme) const;
+    QString render(const QStringList &values) const;
+};
+
+#endif // STYLESHEETENGINE_H
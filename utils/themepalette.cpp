@@ -0,0 +1,151 @@
+#include "themepalette.h"
+#include "database/database.h"
+
+ThemePalette& ThemePalette::instance()
+{
+    static ThemePalette instance;
+    return instance;
+}
+
+static QVector<QColor> defaultChartColors()
+{
+    return {
+        QColor("#7696B3"), // 钢蓝
+        QColor("#D69E68"), // 大地橙
+        QColor("#7FA882"), // 鼠尾草绿
+        QColor("#C96A6A"), // 柔和砖红
+        QColor("#B48EAD"), // 莫兰迪紫
+        QColor("#8C949E"), // 冷灰
+        QColor("#88C0D0"), // 北欧蓝
+        QColor("#EBCB8B"), // 麦穗黄
+        QColor("#BF616A")  // 浆果红
+    };
+}
+
+ThemePalette::ChartTheme ThemePalette::printChartTheme()
+{
+    ChartTheme chart;
+    chart.background = QBrush(Qt::white);
+    chart.border = QPen(QColor("#dcdfe6"), 1);
+    chart.title = QColor("#303133");
+    chart.label = QColor("#606266");
+    chart.pointFill = QBrush(Qt::white);
+    chart.colors = defaultChartColors();
+    return chart;
+}
+
+ThemePalette::ThemePalette()
+    : m_isLight(false)
+    , m_revision(0)
+{
+    m_chartTheme.colors = defaultChartColors();
+
+    // 最后一项为未知值时的默认色
+    m_priorityColors = { QColor("#C96A6A"), QColor("#D69E68"), QColor("#7FA882"),
+                         QColor("#8C949E"), QColor("#7696B3") };
+    m_statusColors = { QColor("#7696B3"), QColor("#D69E68"), QColor("#7FA882"),
+                       QColor("#C96A6A"), QColor("#8C949E") };
+
+    m_calendarDots[DotDelayed] = QColor("#F44336");
+    m_calendarDots[DotInProgress] = QColor("#FF9800");
+    m_calendarDots[DotTodo] = QColor("#2196F3");
+    m_calendarDots[DotDone] = QColor("#4CAF50");
+    m_calendarDots[DotInspiration] = QColor("#9b59b6");
+
+    m_overdue = QColor("#FF6B6B");
+
+    reload();
+}
+
+void ThemePalette::reload()
+{
+    bool isLight = (Database::instance().getSetting("bg_mode", "dark") == "light");
+    QColor theme(Database::instance().getSetting("theme_color", "#657896"));
+    if (!theme.isValid()) theme = QColor("#657896");
+
+    if (m_revision > 0 && isLight == m_isLight && theme == m_theme) return;
+
+    rebuild(isLight, theme);
+    m_revision++;
+    emit paletteChanged();
+}
+
+void ThemePalette::rebuild(bool isLight, const QColor &theme)
+{
+    m_isLight = isLight;
+    m_theme = theme;
+
+    m_text = isLight ? QColor("#303133") : QColor(Qt::white);
+    m_subText = isLight ? QColor("#909399") : QColor("#cccccc");
+    m_border = isLight ? QColor("#dcdfe6") : QColor("#3d3d3d");
+
+    QColor themeAlpha = theme;
+
+    // 看板卡片
+    CardStyle &kanbanNormal = m_kanbanCard[CardNormal];
+    kanbanNormal.background = QBrush(isLight ? QColor(Qt::white) : QColor("#262626"));
+    kanbanNormal.border = QPen(m_border);
+    kanbanNormal.text = m_text;
+    kanbanNormal.subText = m_subText;
+    m_kanbanCard[CardHover] = kanbanNormal;
+
+    CardStyle &kanbanSelected = m_kanbanCard[CardSelected];
+    themeAlpha.setAlpha(isLight ? 40 : 60);
+    kanbanSelected.background = QBrush(themeAlpha);
+    kanbanSelected.border = QPen(theme);
+    kanbanSelected.text = m_text;
+    kanbanSelected.subText = m_subText;
+
+    m_kanbanTagBrush = QBrush(isLight ? QColor("#f5f7fa") : QColor("#333333"));
+
+    // 灵感网格卡片
+    CardStyle &inspSelected = m_inspirationCard[CardSelected];
+    themeAlpha.setAlpha(isLight ? 40 : 60);
+    inspSelected.background = QBrush(themeAlpha);
+    inspSelected.border = QPen(theme, 1);
+    inspSelected.text = m_text;
+    inspSelected.subText = isLight ? theme : QColor(255, 255, 255, 200);
+
+    CardStyle &inspHover = m_inspirationCard[CardHover];
+    themeAlpha.setAlpha(isLight ? 20 : 30);
+    inspHover.background = QBrush(themeAlpha);
+    QColor hoverBorder = theme;
+    hoverBorder.setAlpha(100);
+    inspHover.border = QPen(hoverBorder, 1);
+    inspHover.text = m_text;
+    inspHover.subText = isLight ? QColor("#909399") : QColor("#aaaaaa");
+
+    CardStyle &inspNormal = m_inspirationCard[CardNormal];
+    themeAlpha.setAlpha(isLight ? 75 : 85);
+    inspNormal.background = QBrush(themeAlpha);
+    inspNormal.border = QPen(m_border, 1);
+    inspNormal.text = m_text;
+    inspNormal.subText = m_subText;
+
+    // 统计图表
+    m_chartTheme.background = QBrush(isLight ? QColor("#F5F7FA") : QColor("#303030"));
+    m_chartTheme.border = QPen(isLight ? QColor("#dcdfe6") : QColor("#555555"), 1);
+    m_chartTheme.title = m_text;
+    m_chartTheme.label = isLight ? QColor("#606266") : QColor("#cccccc");
+    m_chartTheme.pointFill = QBrush(isLight ? QColor(Qt::white) : QColor("#2d2d2d"));
+
+    // 热力图：0 级为空格子，其余按主题色逐级加深
+    m_heatmapLevels[0] = isLight ? QColor("#ebedf0") : QColor("#3a3a3a");
+    for (int i = 1; i < HeatmapLevelCount; ++i) {
+        QColor c = theme;
+        c.setAlpha(40 + i * 215 / (HeatmapLevelCount - 1));
+        m_heatmapLevels[i] = c;
+    }
+}
+
+const QColor &ThemePalette::priorityColor(int priority) const
+{
+    if (priority < 0 || priority >= m_priorityColors.size() - 1) return m_priorityColors.last();
+    return m_priorityColors[priority];
+}
+
+const QColor &ThemePalette::statusColor(int status) const
+{
+    if (status < 0 || status >= m_statusColors.size() - 1) return m_statusColors.last();
+    return m_statusColors[status];
+}
@@ -0,0 +1,102 @@
+#ifndef THEMEPALETTE_H
+#define THEMEPALETTE_H
+
+#include <QObject>
+#include <QColor>
+#include <QBrush>
+#include <QPen>
+#include <QVector>
+
+// 预先计算好的界面配色，只在 bg_mode / theme_color 变化时重建，绘制路径不再解析颜色字符串
+class ThemePalette : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum CardState { CardNormal, CardHover, CardSelected, CardStateCount };
+    enum CalendarDot { DotDelayed, DotInProgress, DotTodo, DotDone, DotInspiration, CalendarDotCount };
+    enum { HeatmapLevelCount = 5 };
+
+    struct CardStyle {
+        QBrush background;
+        QPen border;
+        QColor text;
+        QColor subText;
+    };
+
+    // 图表绘制所需的全部颜色，界面和导出各用一份
+    struct ChartTheme {
+        QBrush background;
+        QPen border;
+        QColor title;
+        QColor label;
+        QBrush pointFill;
+        QVector<QColor> colors;
+
+        const QColor &color(int index) const { return colors[index % colors.size()]; }
+    };
+
+    static ThemePalette& instance();
+    // 导出报表用的白底配色，与当前界面主题无关
+    static ChartTheme printChartTheme();
+
+    void reload();
+
+    bool isLight() const { return m_isLight; }
+    int revision() const { return m_revision; }
+
+    const QColor &theme() const { return m_theme; }
+    const QColor &text() const { return m_text; }
+    const QColor &subText() const { return m_subText; }
+    const QColor &border() const { return m_border; }
+    const QColor &overdue() const { return m_overdue; }
+
+    const CardStyle &kanbanCard(CardState state) const { return m_kanbanCard[state]; }
+    const QBrush &kanbanTagBrush() const { return m_kanbanTagBrush; }
+    const CardStyle &inspirationCard(CardState state) const { return m_inspirationCard[state]; }
+
+    const ChartTheme &chartTheme() const { return m_chartTheme; }
+    const QBrush &chartBackground() const { return m_chartTheme.background; }
+    const QPen &chartBorder() const { return m_chartTheme.border; }
+    const QColor &chartTitle() const { return m_chartTheme.title; }
+    const QColor &chartLabel() const { return m_chartTheme.label; }
+    const QBrush &chartPointFill() const { return m_chartTheme.pointFill; }
+    const QColor &chartColor(int index) const { return m_chartTheme.color(index); }
+    const QColor &heatmapLevel(int level) const { return m_heatmapLevels[qBound(0, level, HeatmapLevelCount - 1)]; }
+
+    const QColor &priorityColor(int priority) const;
+    const QColor &statusColor(int status) const;
+    const QColor &calendarDot(CalendarDot dot) const { return m_calendarDots[dot]; }
+
+signals:
+    void paletteChanged();
+
+private:
+    ThemePalette();
+    ThemePalette(const ThemePalette&) = delete;
+    ThemePalette& operator=(const ThemePalette&) = delete;
+
+    void rebuild(bool isLight, const QColor &theme);
+
+    bool m_isLight;
+    int m_revision;
+
+    QColor m_theme;
+    QColor m_text;
+    QColor m_subText;
+    QColor m_border;
+    QColor m_overdue;
+
+    CardStyle m_kanbanCard[CardStateCount];
+    QBrush m_kanbanTagBrush;
+    CardStyle m_inspirationCard[CardStateCount];
+
+    ChartTheme m_chartTheme;
+    QColor m_heatmapLevels[HeatmapLevelCount];
+
+    QVector<QColor> m_priorityColors;
+    QVector<QColor> m_statusColors;
+    QColor m_calendarDots[CalendarDotCount];
+};
+
+#endif // THEMEPALETTE_H
@@ -0,0 +1,155 @@
+#include "zipwriter.h"
+#include <QDateTime>
+#include <QtEndian>
+
+static void appendUInt16(QByteArray &out, quint16 value)
+{
+    char buf[2];
+    qToLittleEndian(value, buf);
+    out.append(buf, 2);
+}
+
+static void appendUInt32(QByteArray &out, quint32 value)
+{
+    char buf[4];
+    qToLittleEndian(value, buf);
+    out.append(buf, 4);
+}
+
+ZipWriter::ZipWriter(QIODevice *device)
+    : m_device(device), m_currentSize(0), m_inEntry(false)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    QDate date = now.date();
+    QTime time = now.time();
+    m_dosTime = quint16((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+    m_dosDate = quint16(((qMax(1980, date.year()) - 1980) << 9) | (date.month() << 5) | date.day());
+}
+
+quint32 ZipWriter::crc32(quint32 crc, const char *data, qint64 size)
+{
+    static quint32 table[256];
+    static bool tableReady = [] {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            table[i] = c;
+        }
+        return true;
+    }();
+    Q_UNUSED(tableReady);
+
+    crc = ~crc;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ quint8(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+bool ZipWriter::writeRaw(const QByteArray &data)
+{
+    return m_device->write(data) == data.size();
+}
+
+bool ZipWriter::beginEntry(const QString &name)
+{
+    if (m_inEntry && !endEntry()) return false;
+    if (m_device->pos() > 0xFFFFFFFFLL) return false;
+
+    m_current.name = name.toUtf8();
+    m_current.crc = 0;
+    m_current.size = 0;
+    m_current.offset = quint32(m_device->pos());
+    m_currentSize = 0;
+
+    // CRC 和大小先写 0，endEntry 时回填
+    QByteArray header;
+    appendUInt32(header, 0x04034b50);
+    appendUInt16(header, 20);          // 解压所需版本
+    appendUInt16(header, 0x0800);      // 文件名为 UTF-8
+    appendUInt16(header, 0);           // stored
+    appendUInt16(header, m_dosTime);
+    appendUInt16(header, m_dosDate);
+    appendUInt32(header, 0);
+    appendUInt32(header, 0);
+    appendUInt32(header, 0);
+    appendUInt16(header, quint16(m_current.name.size()));
+    appendUInt16(header, 0);
+    header.append(m_current.name);
+
+    m_inEntry = writeRaw(header);
+    return m_inEntry;
+}
+
+bool ZipWriter::write(const char *data, qint64 size)
+{
+    if (!m_inEntry) return false;
+    m_current.crc = crc32(m_current.crc, data, size);
+    m_currentSize += size;
+    if (m_currentSize > 0xFFFFFFFFULL) return false;
+    return m_device->write(data, size) == size;
+}
+
+bool ZipWriter::write(const QByteArray &data)
+{
+    return write(data.constData(), data.size());
+}
+
+bool ZipWriter::endEntry()
+{
+    if (!m_inEntry) return false;
+    m_inEntry = false;
+    m_current.size = quint32(m_currentSize);
+
+    qint64 endPos = m_device->pos();
+    QByteArray patch;
+    appendUInt32(patch, m_current.crc);
+    appendUInt32(patch, m_current.size);
+    appendUInt32(patch, m_current.size);
+    if (!m_device->seek(m_current.offset + 14) || !writeRaw(patch) || !m_device->seek(endPos)) return false;
+
+    m_entries.append(m_current);
+    return true;
+}
+
+bool ZipWriter::finish()
+{
+    if (m_inEntry && !endEntry()) return false;
+
+    qint64 directoryOffset = m_device->pos();
+    if (directoryOffset > 0xFFFFFFFFLL) return false;
+
+    QByteArray directory;
+    for (const Entry &entry : m_entries) {
+        appendUInt32(directory, 0x02014b50);
+        appendUInt16(directory, 20);       // 创建版本
+        appendUInt16(directory, 20);
+        appendUInt16(directory, 0x0800);
+        appendUInt16(directory, 0);
+        appendUInt16(directory, m_dosTime);
+        appendUInt16(directory, m_dosDate);
+        appendUInt32(directory, entry.crc);
+        appendUInt32(directory, entry.size);
+        appendUInt32(directory, entry.size);
+        appendUInt16(directory, quint16(entry.name.size()));
+        appendUInt16(directory, 0);        // 扩展字段
+        appendUInt16(directory, 0);        // 注释
+        appendUInt16(directory, 0);        // 磁盘号
+        appendUInt16(directory, 0);        // 内部属性
+        appendUInt32(directory, 0);        // 外部属性
+        appendUInt32(directory, entry.offset);
+        directory.append(entry.name);
+    }
+
+    quint32 directorySize = quint32(directory.size());
+    appendUInt32(directory, 0x06054b50);
+    appendUInt16(directory, 0);
+    appendUInt16(directory, 0);
+    appendUInt16(directory, quint16(m_entries.size()));
+    appendUInt16(directory, quint16(m_entries.size()));
+    appendUInt32(directory, directorySize);
+    appendUInt32(directory, quint32(directoryOffset));
+    appendUInt16(directory, 0);
+
+    return writeRaw(directory);
+}
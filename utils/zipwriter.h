@@ -0,0 +1,43 @@
+#ifndef ZIPWRITER_H
+#define ZIPWRITER_H
+
+#include <QIODevice>
+#include <QList>
+#include <QByteArray>
+
+// 最小的 ZIP 写入器：条目以不压缩（stored）方式边写边算 CRC32，写完回填本地文件头
+// 只在内存中保留中央目录，条目内容大小与内存无关；不支持 ZIP64，单个文件需小于 4GB
+class ZipWriter
+{
+public:
+    explicit ZipWriter(QIODevice *device);
+
+    bool beginEntry(const QString &name);
+    bool write(const char *data, qint64 size);
+    bool write(const QByteArray &data);
+    bool endEntry();
+    // 写入中央目录，之后不能再添加条目
+    bool finish();
+
+    static quint32 crc32(quint32 crc, const char *data, qint64 size);
+
+private:
+    struct Entry {
+        QByteArray name;
+        quint32 crc;
+        quint32 size;
+        quint32 offset;
+    };
+
+    QIODevice *m_device;
+    QList<Entry> m_entries;
+    Entry m_current;
+    quint64 m_currentSize;
+    bool m_inEntry;
+    quint16 m_dosTime;
+    quint16 m_dosDate;
+
+    bool writeRaw(const QByteArray &data);
+};
+
+#endif // ZIPWRITER_H
@@ -4,9 +4,11 @@
 #include <QEvent>
 #include "models/taskmodel.h"
 #include "models/inspirationmodel.h"
+#include "utils/themepalette.h"
 #include <QPainter>
 #include <QTextCharFormat>
 #include <QDebug>
+#include <QTimer>
 
 CalendarView::CalendarView(QWidget *parent)
     : QCalendarWidget(parent)
@@ -35,9 +37,9 @@ void CalendarView::setTaskModel(TaskModel *model)
     if (m_model) {
         connect(m_model, &TaskModel::modelReset, this, &CalendarView::refreshTasks);
         connect(m_model, &TaskModel::layoutChanged, this, &CalendarView::refreshTasks);
-        connect(m_model, &TaskModel::rowsInserted, this, &CalendarView::refreshTasks);
-        connect(m_model, &TaskModel::rowsRemoved, this, &CalendarView::refreshTasks);
-        connect(m_model, &TaskModel::dataChanged, this, &CalendarView::refreshTasks);
+        connect(m_model, &TaskModel::rowsInserted, this, &CalendarView::scheduleRefresh);
+        connect(m_model, &TaskModel::rowsRemoved, this, &CalendarView::scheduleRefresh);
+        connect(m_model, &TaskModel::dataChanged, this, &CalendarView::scheduleRefresh);
         refreshTasks();
     }
 }
@@ -60,6 +62,16 @@ void CalendarView::refreshTasks()
     update();
 }
 
+void CalendarView::scheduleRefresh()
+{
+    if (m_refreshPending) return;
+    m_refreshPending = true;
+    QTimer::singleShot(0, this, [this](){
+        m_refreshPending = false;
+        refreshTasks();
+    });
+}
+
 void CalendarView::updateTaskCache()
 {
     m_taskStatusColors.clear();
@@ -99,14 +111,15 @@ void CalendarView::updateTaskCache()
             else if (status == 2) stats.completedCount++;
         }
 
+        const ThemePalette &themePalette = ThemePalette::instance();
         for (auto it = statsMap.begin(); it != statsMap.end(); ++it) {
             const DayStats &s = it.value();
             QColor color;
 
-            if (s.hasDelayed) color = QColor("#F44336");
-            else if (s.hasInProgress) color = QColor("#FF9800");
-            else if (s.hasTodo) color = QColor("#2196F3");
-            else if (s.totalCount > 0 && s.totalCount == s.completedCount) color = QColor("#4CAF50");
+            if (s.hasDelayed) color = themePalette.calendarDot(ThemePalette::DotDelayed);
+            else if (s.hasInProgress) color = themePalette.calendarDot(ThemePalette::DotInProgress);
+            else if (s.hasTodo) color = themePalette.calendarDot(ThemePalette::DotTodo);
+            else if (s.totalCount > 0 && s.totalCount == s.completedCount) color = themePalette.calendarDot(ThemePalette::DotDone);
 
             if (color.isValid()) {
                 m_taskStatusColors[it.key()] = color;
@@ -136,7 +149,7 @@ void CalendarView::paintCell(QPainter *painter, const QRect &rect, QDate date) c
         QRect inspRect(rect.left() + margin, rect.bottom() - margin - dotSize, dotSize, dotSize);
         m_inspRects[date] = inspRect;
 
-        painter->setBrush(QColor("#9b59b6"));
+        painter->setBrush(ThemePalette::instance().calendarDot(ThemePalette::DotInspiration));
         painter->setPen(Qt::NoPen);
         painter->drawEllipse(inspRect);
     }
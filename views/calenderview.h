@@ -38,12 +38,15 @@ private:
     mutable QMap<QDate, QRect> m_taskRects;
 
     void updateTaskCache();
+    // 模型的增量变化逐行发出信号，合并到下一轮事件循环只重建一次缓存
+    void scheduleRefresh();
     QTableView* getInternalView() const;
 
     int m_filterCategoryId = -1;
     int m_filterPriority = -1;
     QStringList m_inspFilterTags;
     bool m_inspFilterMatchAll = false;
+    bool m_refreshPending = false;
 };
 
 #endif // CALENDARVIEW_H
@@ -1,14 +1,16 @@
 #include "inspirationview.h"
 #include "models/inspirationmodel.h"
+#include "models/inspirationfiltermodel.h"
 #include "dialogs/inspirationdialog.h"
 #include "views/calenderview.h"
 #include "models/taskmodel.h"
 #include "database/database.h"
+#include "utils/themepalette.h"
 #include "dialogs/inspirationrecyclebindialog.h"
 #include "dialogs/inspirationtagsearchdialog.h"
 #include <QPainter>
 #include <QDateTime>
-#include <QListWidget>
+#include <QListView>
 #include <QStackedWidget>
 #include <QButtonGroup>
 #include <QVBoxLayout>
@@ -22,11 +24,23 @@
 #include <QMessageBox>
 #include <QDebug>
 
+static const int kPreviewChars = 300;
+
 InspirationGridDelegate::InspirationGridDelegate(QObject *parent)
-    : QStyledItemDelegate(parent)
+    : QStyledItemDelegate(parent), m_fontsReady(false)
 {
 }
 
+void InspirationGridDelegate::ensureFonts(const QFont &base) const
+{
+    if (m_fontsReady && base == m_baseFont) return;
+
+    m_baseFont = base;
+    m_timeFont = base;
+    m_timeFont.setPointSizeF(9);
+    m_fontsReady = true;
+}
+
 void InspirationGridDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     if (!index.isValid()) return;
@@ -34,61 +48,49 @@ void InspirationGridDelegate::paint(QPainter *painter, const QStyleOptionViewIte
     painter->save();
     painter->setRenderHint(QPainter::Antialiasing);
 
-    QVariantMap data = index.data(Qt::UserRole).toMap();
-    QString content = data["content"].toString();
-    QDateTime createTime = data["created_at"].toDateTime();
+    QString content = index.data(InspirationModel::ContentRole).toString();
+    QDateTime createTime = index.data(InspirationModel::CreatedAtRole).toDateTime();
     QString timeStr = createTime.isValid() ? createTime.toString("MM-dd HH:mm") : "";
 
     QRect rect = option.rect.adjusted(6, 6, -6, -6);
 
-    QString themeColorStr = Database::instance().getSetting("theme_color", "#657896");
-    QColor themeColor(themeColorStr);
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    bool isLight = (bgMode == "light");
-
-    QColor bgColor, borderColor, textColor, timeColor;
-
+    ThemePalette::CardState state = ThemePalette::CardNormal;
     if (option.state & QStyle::State_Selected) {
-        bgColor = themeColor;
-        bgColor.setAlpha(isLight ? 40 : 60);
-        borderColor = themeColor;
-        textColor = isLight ? QColor("#303133") : Qt::white;
-        timeColor = isLight ? themeColor : QColor(255, 255, 255, 200);
+        state = ThemePalette::CardSelected;
     } else if (option.state & QStyle::State_MouseOver) {
-        bgColor = themeColor;
-        bgColor.setAlpha(isLight ? 20 : 30);
-        borderColor = themeColor;
-        borderColor.setAlpha(100);
-        textColor = isLight ? QColor("#303133") : Qt::white;
-        timeColor = isLight ? QColor("#909399") : QColor("#aaaaaa");
-    } else {
-        bgColor = themeColor;
-        bgColor.setAlpha(isLight ?75 : 85);
-
-        if (isLight) {
-            borderColor = QColor("#dcdfe6");
-            textColor = QColor("#303133");
-            timeColor = QColor("#909399");
-        } else {
-            borderColor = QColor("#3d3d3d");
-            textColor = QColor("#ffffff");
-            timeColor = QColor("#cccccc");
-        }
+        state = ThemePalette::CardHover;
     }
+    const ThemePalette::CardStyle &card = ThemePalette::instance().inspirationCard(state);
+    const QColor &textColor = card.text;
+    const QColor &timeColor = card.subText;
 
-    painter->setBrush(bgColor);
-    painter->setPen(QPen(borderColor, 1));
+    painter->setBrush(card.background);
+    painter->setPen(card.border);
     painter->drawRoundedRect(rect, 10, 10);
 
+    int inspirationId = index.data(InspirationModel::IdRole).toInt();
+    ensureFonts(painter->font());
+
+    // 卡片只能显示几行，长文本截断后再排版，避免每次都对全文换行
     painter->setPen(textColor);
     QRect textRect = rect.adjusted(12, 12, -12, -25);
-    painter->drawText(textRect, Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap, content);
+    const QStaticText &contentText = m_textCache.wrapped(inspirationId, ContentSlot,
+                                                         content.left(kPreviewChars), textRect.width(), m_baseFont);
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->drawStaticText(textRect.topLeft(), contentText);
+    painter->restore();
 
-    painter->setPen(timeColor);
-    QFont timeFont = painter->font();
-    timeFont.setPointSizeF(9);
-    painter->setFont(timeFont);
-    painter->drawText(rect.adjusted(0, 0, -10, -8), Qt::AlignRight | Qt::AlignBottom, timeStr);
+    if (!timeStr.isEmpty()) {
+        painter->setPen(timeColor);
+        painter->setFont(m_timeFont);
+        const QStaticText &timeText = m_textCache.plain(inspirationId, TimeSlot, timeStr, m_timeFont);
+        QSizeF timeSize = timeText.size();
+        QRect timeRect = rect.adjusted(0, 0, -10, -8);
+        painter->drawStaticText(QPointF(timeRect.x() + timeRect.width() - timeSize.width(),
+                                        timeRect.y() + timeRect.height() - timeSize.height()),
+                                timeText);
+    }
 
     painter->restore();
 }
@@ -102,7 +104,7 @@ QSize InspirationGridDelegate::sizeHint(const QStyleOptionViewItem &option, cons
 }
 
 InspirationView::InspirationView(QWidget *parent)
-    : QWidget(parent), m_model(nullptr)
+    : QWidget(parent), m_model(nullptr), m_filterModel(nullptr)
 {
     setupUI();
 }
@@ -168,13 +170,17 @@ void InspirationView::setupUI()
     m_tableView->setFrameShape(QFrame::NoFrame);
     m_viewStack->addWidget(m_tableView);
 
-    m_gridView = new QListWidget(this);
-    m_gridView->setViewMode(QListWidget::IconMode);
-    m_gridView->setResizeMode(QListWidget::Adjust);
+    m_gridView = new QListView(this);
+    m_gridView->setViewMode(QListView::IconMode);
+    m_gridView->setResizeMode(QListView::Adjust);
     m_gridView->setSpacing(8);
-    m_gridView->setMovement(QListWidget::Static);
-    m_gridView->setSelectionMode(QListWidget::SingleSelection);
+    m_gridView->setMovement(QListView::Static);
+    m_gridView->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_gridView->setUniformItemSizes(true);
     m_gridView->setItemDelegate(new InspirationGridDelegate(this));
+    connect(&ThemePalette::instance(), &ThemePalette::paletteChanged, m_gridView->viewport(), [this](){
+        m_gridView->viewport()->update();
+    });
 
     QFont font = m_gridView->font();
     font.setPointSize(10);
@@ -281,16 +287,8 @@ void InspirationView::setupUI()
     connect(m_tableView, &QTableView::doubleClicked,
             this, &InspirationView::onDoubleClicked);
 
-    connect(m_gridView, &QListWidget::itemDoubleClicked, this, [this](QListWidgetItem *item){
-        int id = item->data(Qt::UserRole).toMap()["id"].toInt();
-        for(int i = 0; i < m_model->rowCount(); ++i) {
-            QModelIndex idx = m_model->index(i, 0);
-            if (m_model->data(idx, Qt::UserRole).toMap()["id"].toInt() == id) {
-                onDoubleClicked(idx);
-                break;
-            }
-        }
-    });
+    connect(m_gridView, &QListView::doubleClicked,
+            this, &InspirationView::onDoubleClicked);
 
     connect(addBtn, &QPushButton::clicked, this, &InspirationView::onAddClicked);
     connect(editBtn, &QPushButton::clicked, this, &InspirationView::onEditClicked);
@@ -309,7 +307,14 @@ void InspirationView::setupUI()
 void InspirationView::setModel(InspirationModel *model)
 {
     m_model = model;
-    m_tableView->setModel(model);
+
+    if (!m_filterModel) {
+        m_filterModel = new InspirationFilterModel(this);
+    }
+    m_filterModel->setSourceModel(model);
+
+    m_tableView->setModel(m_filterModel);
+    m_gridView->setModel(m_filterModel);
 
     m_tableView->horizontalHeader()->setMinimumSectionSize(100);
     m_tableView->horizontalHeader()->setStretchLastSection(true);
@@ -320,13 +325,6 @@ void InspirationView::setModel(InspirationModel *model)
     m_tableView->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Interactive);
 
     m_calendarView->setInspirationModel(model);
-
-    refreshGridView();
-
-    connect(model, &QAbstractTableModel::modelReset, this, &InspirationView::refreshGridView);
-    connect(model, &QAbstractTableModel::rowsInserted, this, &InspirationView::refreshGridView);
-    connect(model, &QAbstractTableModel::rowsRemoved, this, &InspirationView::refreshGridView);
-    connect(model, &QAbstractTableModel::dataChanged, this, &InspirationView::refreshGridView);
 }
 
 void InspirationView::refresh()
@@ -368,94 +366,29 @@ void InspirationView::onTagSearchClicked()
 
 void InspirationView::applyFilters()
 {
-    if (!m_model) return;
+    if (!m_model || !m_filterModel) return;
 
     if (m_calendarView) {
         m_calendarView->setInspirationFilter(m_filterTags, m_filterMatchAll);
     }
 
-    QString search = m_searchEdit->text();
-
-    bool filterDate = m_dateFilterCheck->isChecked();
-    int targetYear = m_yearSpin->value();
-    int targetMonth = m_monthSpin->value();
-
-    for (int i = 0; i < m_model->rowCount(); ++i) {
-        QModelIndex idx = m_model->index(i, 0);
-        QVariantMap data = m_model->data(idx, Qt::UserRole).toMap();
-
-        QString content = data["content"].toString();
-        QString tagsStr = data["tags"].toString();
-        QDateTime createTime = data["created_at"].toDateTime();
-        QStringList itemTags = tagsStr.split(",", Qt::SkipEmptyParts);
-
-        bool dateMatch = true;
-        if (filterDate) {
-            if (createTime.date().year() != targetYear ||
-                createTime.date().month() != targetMonth) {
-                dateMatch = false;
-            }
-        }
-
-        bool tagMatch = true;
-        if (!m_filterTags.isEmpty()) {
-            if (m_filterMatchAll) {
-                for (const QString &filterTag : m_filterTags) {
-                    if (!itemTags.contains(filterTag, Qt::CaseInsensitive)) {
-                        tagMatch = false;
-                        break;
-                    }
-                }
-                if (tagMatch) {
-                    int validItemTagCount = 0;
-                    for(const QString& t : itemTags) {
-                        if(!t.trimmed().isEmpty()) validItemTagCount++;
-                    }
-
-                    if (validItemTagCount != m_filterTags.size()) {
-                        tagMatch = false;
-                    }
-                }
-
-            } else {
-                tagMatch = false;
-                for (const QString &filterTag : m_filterTags) {
-                    for (const QString &itemTag : itemTags) {
-                        if (itemTag.trimmed() == filterTag) {
-                            tagMatch = true;
-                            break;
-                        }
-                    }
-                    if (tagMatch) break;
-                }
-            }
-        }
-
-        bool searchMatch = search.isEmpty() ||
-                           content.contains(search, Qt::CaseInsensitive) ||
-                           tagsStr.contains(search, Qt::CaseInsensitive);
-
-        bool shouldShow = dateMatch && tagMatch && searchMatch;
-
-        m_tableView->setRowHidden(i, !shouldShow);
-
-        if (m_gridView && i < m_gridView->count()) {
-            m_gridView->item(i)->setHidden(!shouldShow);
-        }
-    }
+    m_filterModel->setTagFilter(m_filterTags, m_filterMatchAll);
+    m_filterModel->setMonthFilter(m_dateFilterCheck->isChecked(), m_yearSpin->value(), m_monthSpin->value());
+    m_filterModel->setSearchText(m_searchEdit->text());
 }
 
 void InspirationView::onSearchTextChanged(const QString &text)
 {
-    Q_UNUSED(text);
-    applyFilters();
+    if (m_filterModel) {
+        m_filterModel->setSearchText(text);
+    }
 }
 
 void InspirationView::onDoubleClicked(const QModelIndex &index)
 {
     if (!m_model) return;
 
-    QVariantMap data = m_model->data(index, Qt::UserRole).toMap();
+    QVariantMap data = index.data(Qt::UserRole).toMap();
     InspirationDialog dialog(data, this);
 
     if (dialog.exec() == QDialog::Accepted) {
@@ -483,16 +416,14 @@ void InspirationView::onAddClicked()
 void InspirationView::onDeleteClicked()
 {
     int id = -1;
+    QModelIndex index;
     if (m_viewStack->currentIndex() == 0) {
-        QModelIndex index = m_tableView->currentIndex();
-        if (index.isValid()) {
-            id = m_model->data(index, Qt::UserRole).toMap()["id"].toInt();
-        }
+        index = m_tableView->currentIndex();
     } else if (m_viewStack->currentIndex() == 1) {
-        QList<QListWidgetItem*> selected = m_gridView->selectedItems();
-        if (!selected.isEmpty()) {
-            id = selected.first()->data(Qt::UserRole).toMap()["id"].toInt();
-        }
+        index = m_gridView->currentIndex();
+    }
+    if (index.isValid()) {
+        id = index.data(InspirationModel::IdRole).toInt();
     }
 
     if (id == -1) {
@@ -510,18 +441,15 @@ void InspirationView::onEditClicked()
     QVariantMap data;
     bool hasSelection = false;
 
+    QModelIndex index;
     if (m_viewStack->currentIndex() == 0) {
-        QModelIndex index = m_tableView->currentIndex();
-        if (index.isValid()) {
-            data = m_model->data(index, Qt::UserRole).toMap();
-            hasSelection = true;
-        }
+        index = m_tableView->currentIndex();
     } else if (m_viewStack->currentIndex() == 1) {
-        QList<QListWidgetItem*> selected = m_gridView->selectedItems();
-        if (!selected.isEmpty()) {
-            data = selected.first()->data(Qt::UserRole).toMap();
-            hasSelection = true;
-        }
+        index = m_gridView->currentIndex();
+    }
+    if (index.isValid()) {
+        data = index.data(Qt::UserRole).toMap();
+        hasSelection = true;
     }
 
     if (hasSelection) {
@@ -538,20 +466,6 @@ void InspirationView::onEditClicked()
     }
 }
 
-void InspirationView::refreshGridView()
-{
-    if (!m_gridView || !m_model) return;
-
-    m_gridView->clear();
-    QList<QVariantMap> inspirations = m_model->getAllInspirations();
-
-    for (const QVariantMap &data : inspirations) {
-        QListWidgetItem *item = new QListWidgetItem();
-        item->setData(Qt::UserRole, data);
-        m_gridView->addItem(item);
-    }
-}
-
 void InspirationView::setTaskModel(TaskModel *model)
 {
     if (m_calendarView) {
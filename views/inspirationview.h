@@ -3,15 +3,17 @@
 
 #include <QWidget>
 #include <QStyledItemDelegate>
-#include <QListWidget>
+#include <QListView>
 #include <QStackedWidget>
 #include <QButtonGroup>
 #include <QDate>
 #include <QSpinBox>
 #include <QCheckBox>
 #include <QComboBox>
+#include "widgets/textlayoutcache.h"
 
 class InspirationModel;
+class InspirationFilterModel;
 class QTableView;
 class QLineEdit;
 class QSpinBox;
@@ -25,6 +27,16 @@ public:
 
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
     QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+private:
+    enum TextSlot { ContentSlot, TimeSlot };
+
+    mutable TextLayoutCache m_textCache;
+    mutable QFont m_baseFont;
+    mutable QFont m_timeFont;
+    mutable bool m_fontsReady;
+
+    void ensureFonts(const QFont &base) const;
 };
 
 class CalendarView;
@@ -64,16 +76,16 @@ private slots:
 
 private:
     InspirationModel *m_model;
+    InspirationFilterModel *m_filterModel;
 
     QStackedWidget *m_viewStack;
     QTableView *m_tableView;
-    QListWidget *m_gridView;
+    QListView *m_gridView;
     CalendarView *m_calendarView;
     QLineEdit *m_searchEdit;
     QStringList m_filterTags;
     bool m_filterMatchAll;
     void setupUI();
-    void refreshGridView();
     void applyFilters();
     QWidget *m_leftBottomContainer;
     QCheckBox *m_dateFilterCheck;
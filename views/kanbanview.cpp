@@ -2,6 +2,7 @@
 #include "models/taskmodel.h"
 #include "models/taskfiltermodel.h"
 #include "database/database.h"
+#include "utils/themepalette.h"
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -11,8 +12,30 @@
 #include <QDebug>
 #include <QDrag>
 #include <QComboBox>
+#include <QtMath>
+#include <QPixmapCache>
 
-KanbanDelegate::KanbanDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+quint64 KanbanDelegate::s_revisionCounter = 0;
+
+KanbanDelegate::KanbanDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_fontsReady(false)
+    , m_generation(++s_revisionCounter)
+{
+}
+
+void KanbanDelegate::ensureFonts(const QFont &base) const
+{
+    if (m_fontsReady && base == m_baseFont) return;
+
+    m_baseFont = base;
+    m_titleFont = base;
+    m_titleFont.setBold(true);
+    m_titleFont.setPointSize(10);
+    m_tagFont = m_titleFont;
+    m_tagFont.setPointSize(8);
+    m_fontsReady = true;
+}
 
 QSize KanbanDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
@@ -21,10 +44,85 @@ QSize KanbanDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelI
     return QSize(200, 72);
 }
 
+void KanbanDelegate::trackModel(QAbstractItemModel *model)
+{
+    if (m_trackedModel) {
+        disconnect(m_trackedModel, nullptr, this, nullptr);
+    }
+    m_trackedModel = model;
+    m_generation = ++s_revisionCounter;
+    m_revisions.clear();
+    if (!model) return;
+
+    connect(model, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            int taskId = m_trackedModel->index(row, 0).data(TaskModel::IdRole).toInt();
+            m_revisions[taskId] = ++s_revisionCounter;
+        }
+    });
+    // 任务在其他列时的修改本列收不到 dataChanged，移入时一律视为新内容
+    connect(model, &QAbstractItemModel::rowsInserted, this,
+            [this](const QModelIndex &parent, int first, int last) {
+        for (int row = first; row <= last; ++row) {
+            int taskId = m_trackedModel->index(row, 0, parent).data(TaskModel::IdRole).toInt();
+            m_revisions[taskId] = ++s_revisionCounter;
+        }
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this](const QModelIndex &parent, int first, int last) {
+        for (int row = first; row <= last; ++row) {
+            m_revisions.remove(m_trackedModel->index(row, 0, parent).data(TaskModel::IdRole).toInt());
+        }
+    });
+    connect(model, &QAbstractItemModel::modelReset, this, [this]() {
+        m_generation = ++s_revisionCounter;
+        m_revisions.clear();
+    });
+}
+
 void KanbanDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
     if (!index.isValid()) return;
 
+    // 卡片整体缓存为位图，稳态下每张卡片只需一次 drawPixmap
+    int taskId = index.data(TaskModel::IdRole).toInt();
+    bool selected = option.state.testFlag(QStyle::State_Selected);
+    bool overdue = index.data(TaskModel::IsOverdueRole).toBool();
+    qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+
+    QString key = QString("kanban_card_%1_%2_%3_%4_%5x%6_%7%8_%9")
+                      .arg(m_generation)
+                      .arg(taskId)
+                      .arg(m_revisions.value(taskId, 0))
+                      .arg(ThemePalette::instance().revision())
+                      .arg(option.rect.width())
+                      .arg(option.rect.height())
+                      .arg(selected ? 1 : 0)
+                      .arg(overdue ? 1 : 0)
+                      .arg(dpr);
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap)) {
+        pixmap = QPixmap(option.rect.size() * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(Qt::transparent);
+
+        QPainter cardPainter(&pixmap);
+        cardPainter.setFont(painter->font());
+        QStyleOptionViewItem cardOption(option);
+        cardOption.rect = QRect(QPoint(0, 0), option.rect.size());
+        drawCard(&cardPainter, cardOption, index);
+        cardPainter.end();
+
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    painter->drawPixmap(option.rect.topLeft(), pixmap);
+}
+
+void KanbanDelegate::drawCard(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
     painter->save();
     painter->setRenderHint(QPainter::Antialiasing);
 
@@ -35,37 +133,16 @@ void KanbanDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option
     QDateTime deadline = index.data(TaskModel::DeadlineRole).toDateTime();
     QDateTime completedAt = index.data(TaskModel::CompletedAtRole).toDateTime();
 
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    bool isLight = (bgMode == "light");
-
-    QColor cardBgColor, textColor, subTextColor, tagBgColor, borderColor;
-
-    if (isLight) {
-        cardBgColor = QColor("#ffffff");
-        textColor = QColor("#303133");
-        subTextColor = QColor("#909399");
-        tagBgColor = QColor("#f5f7fa");
-        borderColor = QColor("#dcdfe6");
-    } else {
-        cardBgColor = QColor("#262626");
-        textColor = QColor("#ffffff");
-        subTextColor = QColor("#cccccc");
-        tagBgColor = QColor("#333333");
-        borderColor = QColor("#3d3d3d");
-    }
+    const ThemePalette &palette = ThemePalette::instance();
+    const ThemePalette::CardStyle &card = palette.kanbanCard(
+        option.state.testFlag(QStyle::State_Selected) ? ThemePalette::CardSelected : ThemePalette::CardNormal);
+    const QColor &textColor = card.text;
+    const QColor &subTextColor = card.subText;
 
     QRect rect = option.rect.adjusted(4, 3, -4, -3);
 
-    if (option.state & QStyle::State_Selected) {
-        QString themeColorStr = Database::instance().getSetting("theme_color", "#657896");
-        QColor themeColor(themeColorStr);
-        themeColor.setAlpha(isLight ? 40 : 60);
-        painter->setBrush(themeColor);
-        painter->setPen(QColor(themeColorStr));
-    } else {
-        painter->setBrush(cardBgColor);
-        painter->setPen(borderColor);
-    }
+    painter->setBrush(card.background);
+    painter->setPen(card.border);
 
     painter->drawRoundedRect(rect, 4, 4);
 
@@ -78,64 +155,60 @@ void KanbanDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option
 
     int leftPadding = 14;
     int rightPadding = 8;
+    int taskId = index.data(TaskModel::IdRole).toInt();
 
-    QFont titleFont = painter->font();
-    titleFont.setBold(true);
-    titleFont.setPointSize(10);
-    painter->setFont(titleFont);
+    ensureFonts(painter->font());
+
+    painter->setFont(m_titleFont);
     painter->setPen(textColor);
 
     QRect titleRect = rect.adjusted(leftPadding, 8, -rightPadding, -28);
-    QString elidedTitle = painter->fontMetrics().elidedText(title, Qt::ElideRight, titleRect.width());
-    painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignTop, elidedTitle);
+    const QStaticText &titleText = m_textCache.elided(taskId, TitleSlot, title, titleRect.width(), m_titleFont);
+    painter->drawStaticText(titleRect.topLeft(), titleText);
 
-    QFont tagFont = painter->font();
-    tagFont.setPointSize(8);
-    painter->setFont(tagFont);
-    QFontMetrics fm(tagFont);
+    painter->setFont(m_tagFont);
 
-    int catWidth = fm.horizontalAdvance(category) + 12;
+    const QStaticText &catText = m_textCache.plain(taskId, CategorySlot, category, m_tagFont);
+    QSizeF catTextSize = catText.size();
+    int catWidth = qCeil(catTextSize.width()) + 12;
     int catHeight = 16;
     QRect catRect(rect.left() + leftPadding, rect.bottom() - 8 - catHeight, catWidth, catHeight);
 
-    painter->setBrush(tagBgColor);
+    painter->setBrush(palette.kanbanTagBrush());
     painter->setPen(Qt::NoPen);
     painter->drawRoundedRect(catRect, 3, 3);
     painter->setPen(subTextColor);
-    painter->drawText(catRect, Qt::AlignCenter, category);
+    painter->drawStaticText(QPointF(catRect.x() + (catRect.width() - catTextSize.width()) / 2.0,
+                                    catRect.y() + (catRect.height() - catTextSize.height()) / 2.0),
+                            catText);
 
-    QString timeStr;
-    QString prefix;
+    QString fullText;
+    bool overdue = false;
 
     if (status == 2) {
         if (completedAt.isValid()) {
-            timeStr = completedAt.toString("MM-dd");
-            prefix = "√ ";
-        }
-    } else {
-        if (deadline.isValid()) {
-            timeStr = deadline.toString("MM-dd");
-            if (index.data(TaskModel::IsOverdueRole).toBool()) {
-                painter->setPen(QColor("#FF6B6B"));
-            } else {
-                painter->setPen(subTextColor);
-            }
+            fullText = "√ " + completedAt.toString("MM-dd");
         }
+    } else if (deadline.isValid()) {
+        fullText = deadline.toString("MM-dd");
+        overdue = index.data(TaskModel::IsOverdueRole).toBool();
     }
 
-    if (!timeStr.isEmpty()) {
-        QString fullText = prefix + timeStr;
-        if (painter->pen().color() != QColor("#FF6B6B")) {
-            painter->setPen(subTextColor);
-        }
-        painter->drawText(rect.adjusted(0, 0, -rightPadding, -8), Qt::AlignRight | Qt::AlignBottom, fullText);
+    if (!fullText.isEmpty()) {
+        const QStaticText &dateText = m_textCache.plain(taskId, DateSlot, fullText, m_tagFont);
+        QSizeF dateSize = dateText.size();
+        QRect dateRect = rect.adjusted(0, 0, -rightPadding, -8);
+        painter->setPen(overdue ? palette.overdue() : subTextColor);
+        painter->drawStaticText(QPointF(dateRect.x() + dateRect.width() - dateSize.width(),
+                                        dateRect.y() + dateRect.height() - dateSize.height()),
+                                dateText);
     }
 
     painter->restore();
 }
 
 KanbanColumn::KanbanColumn(int value, QWidget *parent)
-    : QListView(parent), m_value(value)
+    : QListView(parent), m_value(value), m_delegate(nullptr)
 {
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
@@ -152,7 +225,12 @@ KanbanColumn::KanbanColumn(int value, QWidget *parent)
     setSelectionMode(QAbstractItemView::SingleSelection);
     setSpacing(2);
 
-    setItemDelegate(new KanbanDelegate(this));
+    m_delegate = new KanbanDelegate(this);
+    setItemDelegate(m_delegate);
+
+    connect(&ThemePalette::instance(), &ThemePalette::paletteChanged, viewport(), [this](){
+        viewport()->update();
+    });
 
     connect(this, &QListView::doubleClicked, this, [this](const QModelIndex &index){
         int taskId = index.data(TaskModel::IdRole).toInt();
@@ -162,6 +240,11 @@ KanbanColumn::KanbanColumn(int value, QWidget *parent)
     });
 }
 
+void KanbanColumn::setModel(QAbstractItemModel *model)
+{
+    QListView::setModel(model);
+    m_delegate->trackModel(model);
+}
 
 void KanbanColumn::dropEvent(QDropEvent *event)
 {
@@ -225,6 +308,10 @@ KanbanView::KanbanView(QWidget *parent)
     , m_model(nullptr)
     , m_groupMode(GroupByStatus)
 {
+    // 高分屏下长列的卡片位图较大，默认 10MB 的缓存不够
+    if (QPixmapCache::cacheLimit() < 64 * 1024) {
+        QPixmapCache::setCacheLimit(64 * 1024);
+    }
     setupUI();
 }
 
@@ -4,6 +4,9 @@
 #include <QWidget>
 #include <QListView>
 #include <QStyledItemDelegate>
+#include <QHash>
+#include <QPointer>
+#include "widgets/textlayoutcache.h"
 
 class TaskModel;
 class TaskFilterModel;
@@ -16,6 +19,26 @@ public:
     explicit KanbanDelegate(QObject *parent = nullptr);
     void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
     QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    void trackModel(QAbstractItemModel *model);
+
+private:
+    enum TextSlot { TitleSlot, CategorySlot, DateSlot };
+
+    static quint64 s_revisionCounter;
+
+    mutable TextLayoutCache m_textCache;
+    mutable QFont m_baseFont;
+    mutable QFont m_titleFont;
+    mutable QFont m_tagFont;
+    mutable bool m_fontsReady;
+
+    QPointer<QAbstractItemModel> m_trackedModel;
+    quint64 m_generation;
+    QHash<int, quint64> m_revisions;
+
+    void ensureFonts(const QFont &base) const;
+    void drawCard(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
 };
 
 class KanbanColumn : public QListView
@@ -24,6 +47,7 @@ class KanbanColumn : public QListView
 public:
     explicit KanbanColumn(int value, QWidget *parent = nullptr);
     int getValue() const { return m_value; }
+    void setModel(QAbstractItemModel *model) override;
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -37,6 +61,7 @@ signals:
 
 private:
     int m_value;
+    KanbanDelegate *m_delegate;
 };
 
 class KanbanView : public QWidget
@@ -1,8 +1,11 @@
 #include "statisticview.h"
 #include "models/taskmodel.h"
 #include "widgets/simplechartwidget.h"
+#include "widgets/heatmapwidget.h"
 #include "utils/exporter.h"
 #include "database/database.h"
+#include "threads/statisticthread.h"
+#include "threads/exportthread.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -21,16 +24,61 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QTimer>
-
-StatisticView::StatisticView(QWidget *parent) : QWidget(parent)
+#include <QProgressDialog>
+#include <QMenu>
+
+StatisticView::StatisticView(QWidget *parent)
+    : QWidget(parent)
+    , m_statModel(nullptr)
+    , m_taskModel(nullptr)
+    , m_generation(0)
+    , m_requestTypeIndex(0)
+    , m_exportThread(nullptr)
 {
     m_refreshTimer = new QTimer(this);
     m_refreshTimer->setSingleShot(true);
     m_refreshTimer->setInterval(300);
     connect(m_refreshTimer, &QTimer::timeout, this, &StatisticView::onFilterChanged);
 
+    startStatThread();
+
+    // 恢复备份时后台线程的连接随数据库文件一起关闭、重开
+    connect(&Database::instance(), &Database::aboutToReplaceDatabase, this, [this](){
+        if (m_exportThread) {
+            m_exportThread->cancel();
+            m_exportThread->wait();
+        }
+        m_statThread->stop();
+        m_statThread->wait();
+        delete m_statThread;
+        m_statThread = nullptr;
+    });
+    connect(&Database::instance(), &Database::databaseReplaced, this, [this](){
+        startStatThread();
+        refresh();
+    });
+
     setupUI();
 }
+
+void StatisticView::startStatThread()
+{
+    m_statThread = new StatisticThread(this);
+    connect(m_statThread, &StatisticThread::overviewReady, this, &StatisticView::onOverviewReady);
+    connect(m_statThread, &StatisticThread::trendReady, this, &StatisticView::onTrendReady);
+    m_statThread->start();
+}
+
+StatisticView::~StatisticView()
+{
+    m_statThread->stop();
+    m_statThread->wait();
+
+    if (m_exportThread) {
+        m_exportThread->cancel();
+        m_exportThread->wait();
+    }
+}
 void StatisticView::setupUI()
 {
     this->setObjectName("statisticView");
@@ -176,10 +224,41 @@ void StatisticView::setupUI()
     row3->addWidget(m_statusPie, 1);
     cLayout->addLayout(row3);
 
+    QVBoxLayout *row4 = new QVBoxLayout();
+    row4->setSpacing(8);
+    QHBoxLayout *durationHeader = new QHBoxLayout();
+    m_durationMetricCombo = new QComboBox();
+    m_durationMetricCombo->setObjectName("filterCategoryCombo");
+    m_durationMetricCombo->addItems({"交付周期 (创建→完成)", "执行耗时 (开始→完成)"});
+    m_durationGroupCombo = new QComboBox();
+    m_durationGroupCombo->setObjectName("filterCategoryCombo");
+    m_durationGroupCombo->addItem("全部任务");
+    durationHeader->addStretch();
+    durationHeader->addWidget(m_durationMetricCombo);
+    durationHeader->addWidget(m_durationGroupCombo);
+    m_durationBar = new SimpleChartWidget(SimpleChartWidget::BarChart, "耗时分布");
+    m_durationBar->setMinimumHeight(300);
+    row4->addLayout(durationHeader);
+    row4->addWidget(m_durationBar);
+    cLayout->addLayout(row4);
+
+    m_yearHeatmap = new HeatmapWidget(HeatmapWidget::YearCalendar, "年度完成热力图");
+    m_yearHeatmap->setMinimumHeight(220);
+    cLayout->addWidget(m_yearHeatmap);
+
+    m_weekHourHeatmap = new HeatmapWidget(HeatmapWidget::WeekdayHour, "完成时段分布");
+    m_weekHourHeatmap->setMinimumHeight(260);
+    cLayout->addWidget(m_weekHourHeatmap);
+
     QHBoxLayout *btnLayout = new QHBoxLayout();
-    QPushButton *btnXls = new QPushButton(" 导出数据报告(CSV)");
+    QPushButton *btnXls = new QPushButton(" 导出任务数据");
     btnXls->setObjectName("applyFilterBtn");
     btnXls->setIcon(QIcon(":/icons/export_icon.png"));
+    QMenu *exportMenu = new QMenu(btnXls);
+    exportMenu->addAction("CSV 表格 (*.csv)", this, [this](){ onExportData(ExportThread::TaskCsv); });
+    exportMenu->addAction("Excel 工作簿 (*.xlsx)", this, [this](){ onExportData(ExportThread::TaskXlsx); });
+    exportMenu->addAction("JSON Lines (*.jsonl)", this, [this](){ onExportData(ExportThread::TaskJsonLines); });
+    btnXls->setMenu(exportMenu);
     btnLayout->addSpacing(
         0);
     QPushButton *btnPdf = new QPushButton(" 生成统计报表(PDF)");
@@ -202,8 +281,9 @@ void StatisticView::setupUI()
     connect(m_endDateEdit, &QDateEdit::userDateChanged, this, &StatisticView::onFilterChanged);
 
     connect(applyBtn, &QPushButton::clicked, this, &StatisticView::onFilterChanged);
-    connect(btnXls, &QPushButton::clicked, this, &StatisticView::onExportExcel);
     connect(btnPdf, &QPushButton::clicked, this, &StatisticView::onExportPDF);
+    connect(m_durationMetricCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &StatisticView::updateDurationChart);
+    connect(m_durationGroupCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &StatisticView::updateDurationChart);
     connect(m_categoryList, &QListWidget::itemClicked, this, [](QListWidgetItem* item){
         item->setCheckState(item->checkState() == Qt::Checked ? Qt::Unchecked : Qt::Checked);
     });
@@ -225,6 +305,8 @@ StatisticModel::Filter StatisticView::getCurrentFilter() const
         if (m_categoryList->item(i)->checkState() == Qt::Checked)
             f.categoryIds << m_categoryList->item(i)->data(Qt::UserRole).toInt();
     }
+    // 统计汇总表本就包含归档任务，明细查询也一并包含，两者口径一致
+    f.includeArchive = Database::instance().isArchiveAttached();
     return f;
 }
 
@@ -268,29 +350,47 @@ void StatisticView::onFilterChanged()
 
 void StatisticView::updateContent()
 {
-    StatisticModel::Filter f = getCurrentFilter();
-
-    if (m_statModel) {
-        QVariantMap stats = m_statModel->getOverviewStats(f);
-        m_totalLab->setText(stats["total"].toString());
-        m_compLab->setText(stats["completed"].toString());
-        m_rateLab->setText(QString::number(stats["rate"].toDouble(), 'f', 1) + "%");
-        m_overdueLab->setText(stats["overdue"].toString());
-        double avgTime = m_statModel->getAverageCompletionTime(f);
-        m_avgTimeLab->setText(QString::number(avgTime, 'f', 1));
-        int inspCount = m_statModel->getInspirationCount(f);
-        m_inspLab->setText(QString::number(inspCount));
-    }
+    if (!m_statModel) return;
+
+    // 计算放到统计线程，界面只接收最新一代的结果
+    m_requestFilter = getCurrentFilter();
+    m_requestTypeIndex = m_timeRangeCombo->currentIndex();
+    m_generation++;
+
+    m_statThread->requestStats(m_generation, m_requestFilter,
+                               m_requestTypeIndex == 3 ? StatisticModel::TrendMonthly : StatisticModel::TrendDaily);
+}
+
+void StatisticView::onOverviewReady(quint64 generation, const StatisticModel::Snapshot &snap)
+{
+    if (generation != m_generation) return;
+
+    m_totalLab->setText(QString::number(snap.total));
+    m_compLab->setText(QString::number(snap.completed));
+    m_rateLab->setText(QString::number(snap.rate, 'f', 1) + "%");
+    m_overdueLab->setText(QString::number(snap.overdue));
+    m_inspLab->setText(QString::number(snap.inspirationCount));
+
+    m_catePie->setCategoryData(snap.byCategory);
+    m_prioBar->setCategoryData(snap.byPriority);
+    m_statusPie->setCategoryData(snap.byStatus);
+}
+
+void StatisticView::onTrendReady(quint64 generation, const StatisticModel::Snapshot &snap)
+{
+    if (generation != m_generation) return;
+
+    const StatisticModel::Filter &f = m_requestFilter;
+    int typeIndex = m_requestTypeIndex;
+
+    m_avgTimeLab->setText(QString::number(snap.avgCompletionHours, 'f', 1));
 
-    QVector<int> trendData;
+    QVector<int> trendData = snap.trend;
     QStringList labels;
     QStringList tooltips;
     QString subTitle;
 
-    int typeIndex = m_timeRangeCombo->currentIndex();
-
     if (typeIndex == 3) {
-        trendData = m_statModel->getMonthlyTrend(f);
         for(int i=1; i<=12; ++i) {
             labels << QString("m%1").arg(i);
             tooltips << QString("%1年%2月").arg(f.start.date().year()).arg(i);
@@ -304,14 +404,9 @@ void StatisticView::updateContent()
 
         subTitle = QString("%1 ~ %2").arg(startDate.toString("yyyy.MM.dd")).arg(endDate.toString("yyyy.MM.dd"));
 
+        // 本月视图的趋势线只画到今天
         if (typeIndex == 2 && endDate > today) {
             endDate = today;
-            StatisticModel::Filter f_temp = f;
-            f_temp.end.setDate(endDate);
-            f_temp.end.setTime(QTime(23, 59, 59));
-            trendData = m_statModel->getDailyTrend(f_temp);
-        } else {
-            trendData = m_statModel->getDailyTrend(f);
         }
 
         int days = startDate.daysTo(endDate) + 1;
@@ -328,9 +423,69 @@ void StatisticView::updateContent()
     m_trendLine->setSubTitle(subTitle);
     m_trendLine->setTrendData(trendData, labels, tooltips);
 
-    m_catePie->setCategoryData(m_statModel->getTasksCountByCategory(f));
-    m_prioBar->setCategoryData(m_statModel->getTasksCountByPriority(f));
-    m_statusPie->setCategoryData(m_statModel->getTasksCountByStatus(f));
+    int yearTotal = 0;
+    for (int v : snap.yearHeatmap) yearTotal += v;
+    QDate heatmapEnd = f.end.date();
+    m_yearHeatmap->setSubTitle(QString("%1 ~ %2 · 共完成 %3 项")
+                                   .arg(snap.yearHeatmapStart.toString("yyyy.MM.dd"), heatmapEnd.toString("yyyy.MM.dd"))
+                                   .arg(yearTotal));
+    m_yearHeatmap->setYearData(snap.yearHeatmapStart, heatmapEnd, snap.yearHeatmap);
+    m_weekHourHeatmap->setSubTitle(QString("%1 ~ %2").arg(f.start.date().toString("yyyy.MM.dd"), heatmapEnd.toString("yyyy.MM.dd")));
+    m_weekHourHeatmap->setWeekdayHourData(snap.weekHourHeatmap);
+
+    m_leadTime = snap.leadTime;
+    m_completionTime = snap.completionTime;
+
+    // 分组选项随结果重建，尽量保留当前选择
+    QString currentGroup = m_durationGroupCombo->currentText();
+    bool oldState = m_durationGroupCombo->blockSignals(true);
+    m_durationGroupCombo->clear();
+    m_durationGroupCombo->addItem("全部任务");
+    for (const QString &name : snap.leadTime.byCategory.keys())
+        m_durationGroupCombo->addItem("分类: " + name, QStringList{"category", name});
+    const QStringList priorityNames = {"紧急", "重要", "普通", "不急"};
+    for (const QString &name : priorityNames)
+        m_durationGroupCombo->addItem("优先级: " + name, QStringList{"priority", name});
+    int groupIndex = m_durationGroupCombo->findText(currentGroup);
+    m_durationGroupCombo->setCurrentIndex(groupIndex < 0 ? 0 : groupIndex);
+    m_durationGroupCombo->blockSignals(oldState);
+
+    updateDurationChart();
+}
+
+static QString formatDuration(double hours)
+{
+    if (hours < 1.0) return QString("%1分钟").arg(qRound(hours * 60));
+    if (hours < 48.0) return QString("%1小时").arg(hours, 0, 'f', 1);
+    return QString("%1天").arg(hours / 24.0, 0, 'f', 1);
+}
+
+void StatisticView::updateDurationChart()
+{
+    const StatisticModel::DurationBreakdown &breakdown =
+        m_durationMetricCombo->currentIndex() == 0 ? m_leadTime : m_completionTime;
+
+    DurationSketch sketch = breakdown.overall;
+    QStringList group = m_durationGroupCombo->currentData().toStringList();
+    if (group.size() == 2) {
+        const QMap<QString, DurationSketch> &source =
+            group.at(0) == "category" ? breakdown.byCategory : breakdown.byPriority;
+        sketch = source.value(group.at(1));
+    }
+
+    static const QVector<double> edges = {1, 4, 12, 24, 72, 168, 672};
+    static const QStringList labels = {"<1h", "1-4h", "4-12h", "12-24h", "1-3天", "3-7天", "1-4周", ">4周"};
+
+    if (sketch.isEmpty()) {
+        m_durationBar->setSubTitle("暂无已完成任务");
+    } else {
+        m_durationBar->setSubTitle(QString("P50 %1 · P90 %2 · P99 %3 · 共 %4 项")
+                                       .arg(formatDuration(sketch.quantile(0.5)),
+                                            formatDuration(sketch.quantile(0.9)),
+                                            formatDuration(sketch.quantile(0.99)))
+                                       .arg(sketch.count()));
+    }
+    m_durationBar->setBarData(labels, sketch.histogram(edges));
 }
 
 void StatisticView::setModels(TaskModel *taskModel, StatisticModel *statModel)
@@ -342,8 +497,13 @@ void StatisticView::setModels(TaskModel *taskModel, StatisticModel *statModel)
 
 void StatisticView::refresh() { onFilterChanged(); }
 
-void StatisticView::onExportExcel()
+void StatisticView::onExportData(int job)
 {
+    if (m_exportThread) {
+        QMessageBox::information(this, "提示", "上一次导出尚未完成，请稍候。");
+        return;
+    }
+
     QString docPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
     QString exportPath = docPath + "/TaskManagement_Exports";
     QDir dir(exportPath);
@@ -351,20 +511,65 @@ void StatisticView::onExportExcel()
         dir.mkpath(".");
     }
 
-    QString defaultFileName = exportPath + "/任务数据_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmm") + ".csv";
+    QString suffix = "csv";
+    QString typeName = "CSV";
+    QString fileFilter = "CSV Files (*.csv)";
+    if (job == ExportThread::TaskXlsx) {
+        suffix = "xlsx";
+        typeName = "Excel";
+        fileFilter = "Excel Files (*.xlsx)";
+    } else if (job == ExportThread::TaskJsonLines) {
+        suffix = "jsonl";
+        typeName = "JSON Lines";
+        fileFilter = "JSON Lines Files (*.jsonl)";
+    }
+
+    QString defaultFileName = exportPath + "/任务数据_" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmm") + "." + suffix;
 
-    QString fileName = QFileDialog::getSaveFileName(this, "导出任务数据(CSV)", defaultFileName, "CSV Files (*.csv)");
+    QString fileName = QFileDialog::getSaveFileName(this, QString("导出任务数据(%1)").arg(typeName), defaultFileName, fileFilter);
     if (fileName.isEmpty()) return;
 
-    if (Exporter::exportTasksToCSV(fileName, m_taskModel, getCurrentFilter())) {
-        QMessageBox::information(this, "成功", "导出成功！\n文件位置：" + fileName);
-    } else {
-        QMessageBox::warning(this, "错误", "导出失败，请检查文件权限。");
-    }
+    m_exportThread = new ExportThread(ExportThread::Job(job), fileName, getCurrentFilter(), this);
+    startExport("导出" + typeName, "正在导出任务数据...", "导出成功！", "导出失败，请检查文件权限。");
+}
+
+void StatisticView::startExport(const QString &title, const QString &label,
+                                const QString &successText, const QString &failText)
+{
+    QProgressDialog *progressDialog = new QProgressDialog(label, "取消", 0, 0, this);
+    progressDialog->setWindowTitle(title);
+    progressDialog->setWindowModality(Qt::WindowModal);
+    progressDialog->setMinimumDuration(500);
+
+    // 查询和写文件都在后台线程完成，界面只接收进度
+    connect(m_exportThread, &ExportThread::progressChanged, progressDialog, [progressDialog](int done, int total) {
+        progressDialog->setMaximum(total);
+        progressDialog->setValue(done);
+    });
+    connect(progressDialog, &QProgressDialog::canceled, m_exportThread, &ExportThread::cancel, Qt::DirectConnection);
+    connect(m_exportThread, &ExportThread::exportFinished, this,
+            [this, progressDialog, successText, failText](bool success, bool canceled, const QString &filePath) {
+        progressDialog->deleteLater();
+        m_exportThread->wait();
+        m_exportThread->deleteLater();
+        m_exportThread = nullptr;
+
+        if (success) {
+            QMessageBox::information(this, "成功", successText + "\n文件位置：" + filePath);
+        } else if (!canceled) {
+            QMessageBox::warning(this, "错误", failText);
+        }
+    });
+    m_exportThread->start();
 }
 
 void StatisticView::onExportPDF()
 {
+    if (m_exportThread) {
+        QMessageBox::information(this, "提示", "上一次导出尚未完成，请稍候。");
+        return;
+    }
+
     QString docPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
     QString exportPath = docPath + "/TaskManagement_Exports";
     QDir dir(exportPath);
@@ -377,19 +582,16 @@ void StatisticView::onExportPDF()
     QString fileName = QFileDialog::getSaveFileName(this, "导出统计报表(PDF)", defaultFileName, "PDF Files (*.pdf)");
     if (fileName.isEmpty()) return;
 
-    QList<QPixmap> pixmaps;
-    if (m_catePie) pixmaps << m_catePie->grab();
-    if (m_trendLine) pixmaps << m_trendLine->grab();
-    if (m_prioBar) pixmaps << m_prioBar->grab();
-    if (m_statusPie) pixmaps << m_statusPie->grab();
+    // 图表在界面线程录制为矢量图元，绘制和写文件交给导出线程
+    QList<Exporter::ChartPicture> charts;
+    charts << Exporter::recordChart(m_catePie) << Exporter::recordChart(m_trendLine)
+           << Exporter::recordChart(m_prioBar) << Exporter::recordChart(m_statusPie);
 
     QString aiText = m_aiAnalysisEdit ? m_aiAnalysisEdit->toPlainText() : "";
 
-    if (Exporter::exportReportToPDF(fileName, m_taskModel, m_statModel, getCurrentFilter(), pixmaps, aiText)) {
-        QMessageBox::information(this, "成功", "报表生成成功！\n文件位置：" + fileName);
-    } else {
-        QMessageBox::warning(this, "错误", "生成PDF失败。");
-    }
+    m_exportThread = new ExportThread(ExportThread::ReportPdf, fileName, getCurrentFilter(), this);
+    m_exportThread->setReportContent(charts, aiText);
+    startExport("导出PDF", "正在生成统计报表...", "报表生成成功！", "生成PDF失败。");
 }
 
 void StatisticView::requestDelayedRefresh()
@@ -8,6 +8,7 @@
 
 class TaskModel;
 class SimpleChartWidget;
+class HeatmapWidget;
 class QLabel;
 class QComboBox;
 class QDateEdit;
@@ -18,15 +19,20 @@ class StatisticView : public QWidget
     Q_OBJECT
 public:
     explicit StatisticView(QWidget *parent = nullptr);
+    ~StatisticView();
     void setModels(TaskModel *taskModel, StatisticModel *statModel);
     void refresh();
 
 private slots:
     void onFilterChanged();
     void onTimeRangeTypeChanged(int index);
-    void onExportExcel();
+    // job 为 ExportThread::Job 中的任务数据格式
+    void onExportData(int job);
     void onExportPDF();
     void requestDelayedRefresh();
+    void onOverviewReady(quint64 generation, const StatisticModel::Snapshot &snap);
+    void onTrendReady(quint64 generation, const StatisticModel::Snapshot &snap);
+    void updateDurationChart();
 
 private:
     StatisticModel *m_statModel;
@@ -40,15 +46,31 @@ private:
 
     QLabel *m_totalLab, *m_compLab, *m_rateLab, *m_overdueLab, *m_avgTimeLab, *m_inspLab;
 
-    SimpleChartWidget *m_catePie, *m_prioBar, *m_statusPie, *m_trendLine;
+    SimpleChartWidget *m_catePie, *m_prioBar, *m_statusPie, *m_trendLine, *m_durationBar;
+    HeatmapWidget *m_yearHeatmap, *m_weekHourHeatmap;
+    QComboBox *m_durationMetricCombo;
+    QComboBox *m_durationGroupCombo;
+    StatisticModel::DurationBreakdown m_leadTime;
+    StatisticModel::DurationBreakdown m_completionTime;
 
     QTextEdit *m_aiAnalysisEdit;
 
     class QTimer *m_refreshTimer;
 
+    class StatisticThread *m_statThread;
+    quint64 m_generation;
+    StatisticModel::Filter m_requestFilter;
+    int m_requestTypeIndex;
+
+    class ExportThread *m_exportThread;
+
     void setupUI();
+    void startStatThread();
     StatisticModel::Filter getCurrentFilter() const;
     void updateContent();
+    // 为已创建的 m_exportThread 显示进度对话框并启动，结束后提示结果
+    void startExport(const QString &title, const QString &label,
+                     const QString &successText, const QString &failText);
 
 };
 
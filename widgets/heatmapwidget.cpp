@@ -0,0 +1,296 @@
+#include "heatmapwidget.h"
+#include "utils/themepalette.h"
+#include <QPainter>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QtMath>
+
+static const QStringList kWeekdayNames = {"周一", "周二", "周三", "周四", "周五", "周六", "周日"};
+
+HeatmapWidget::HeatmapWidget(Layout layout, QString title, QWidget *parent)
+    : QWidget(parent), m_layout(layout), m_title(title), m_maxValue(0), m_cacheValid(false), m_pitch(0)
+{
+    setMinimumSize(300, 220);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+    int cellCount = rowCount() * columnCount();
+    m_values.fill(0, cellCount);
+    m_levels.fill(0, cellCount);
+
+    if (m_layout == YearCalendar) {
+        QDate today = QDate::currentDate();
+        m_gridStart = today.addDays(1 - today.dayOfWeek()).addDays(-7 * (columnCount() - 1));
+    } else {
+        for (int h = 0; h < 24; ++h) m_columnLabels << (h % 3 == 0 ? QString::number(h) : QString());
+    }
+
+    connect(&ThemePalette::instance(), &ThemePalette::paletteChanged, this, [this](){
+        m_cacheValid = false;
+        update();
+    });
+}
+
+int HeatmapWidget::rowCount() const
+{
+    return 7;
+}
+
+int HeatmapWidget::columnCount() const
+{
+    return m_layout == YearCalendar ? 53 : 24;
+}
+
+int HeatmapWidget::cellIndex(int row, int column) const
+{
+    return m_layout == YearCalendar ? column * 7 + row : row * 24 + column;
+}
+
+void HeatmapWidget::setYearData(const QDate &gridStart, const QDate &lastDate, const QVector<int> &values)
+{
+    int cellCount = rowCount() * columnCount();
+    QVector<int> cells(cellCount, 0);
+    QVector<qint8> levels(cellCount, 0);
+
+    int maxValue = 0;
+    for (int i = 0; i < cellCount && i < values.size(); ++i) {
+        cells[i] = values[i];
+        if (gridStart.addDays(i) <= lastDate) maxValue = qMax(maxValue, values[i]);
+    }
+    for (int i = 0; i < cellCount; ++i) {
+        levels[i] = gridStart.addDays(i) > lastDate ? -1 : levelFor(cells[i], maxValue);
+    }
+
+    // 每列第一天换月时标注月份
+    if (gridStart != m_gridStart || m_columnLabels.isEmpty()) {
+        m_columnLabels.clear();
+        int lastMonth = -1;
+        for (int c = 0; c < columnCount(); ++c) {
+            int month = gridStart.addDays(c * 7).month();
+            m_columnLabels << (month != lastMonth && c > 0 ? QString("%1月").arg(month) : QString());
+            lastMonth = month;
+        }
+        m_gridStart = gridStart;
+        m_cacheValid = false;
+    }
+
+    m_maxValue = maxValue;
+    applyValues(cells, levels);
+}
+
+void HeatmapWidget::setWeekdayHourData(const QVector<int> &values)
+{
+    int cellCount = rowCount() * columnCount();
+    QVector<int> cells(cellCount, 0);
+    QVector<qint8> levels(cellCount, 0);
+
+    int maxValue = 0;
+    for (int i = 0; i < cellCount && i < values.size(); ++i) {
+        cells[i] = values[i];
+        maxValue = qMax(maxValue, values[i]);
+    }
+    for (int i = 0; i < cellCount; ++i) levels[i] = levelFor(cells[i], maxValue);
+
+    m_maxValue = maxValue;
+    applyValues(cells, levels);
+}
+
+void HeatmapWidget::setSubTitle(const QString &subTitle)
+{
+    m_subTitle = subTitle;
+    update();
+}
+
+int HeatmapWidget::levelFor(int value, int maxValue) const
+{
+    if (value <= 0 || maxValue <= 0) return 0;
+    int top = ThemePalette::HeatmapLevelCount - 1;
+    return qBound(1, (int)qCeil((double)value * top / maxValue), top);
+}
+
+void HeatmapWidget::applyValues(const QVector<int> &values, const QVector<qint8> &levels)
+{
+    QVector<qint8> oldLevels = m_levels;
+    m_values = values;
+    m_levels = levels;
+
+    if (!m_cacheValid || oldLevels.size() != levels.size()) {
+        m_cacheValid = false;
+        update();
+        return;
+    }
+
+    // 缓存有效时只重画颜色等级变化的格子
+    QPainter painter(&m_gridCache);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(-m_gridRect.topLeft());
+
+    for (int row = 0; row < rowCount(); ++row) {
+        for (int column = 0; column < columnCount(); ++column) {
+            int index = cellIndex(row, column);
+            if (oldLevels[index] == levels[index]) continue;
+
+            QRect r = cellRect(row, column);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.fillRect(r, Qt::transparent);
+            painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            paintCell(painter, row, column);
+            update(r);
+        }
+    }
+}
+
+void HeatmapWidget::updateGridGeometry()
+{
+    // 左侧留给星期标签，上方留给标题、副标题和列标签
+    QRect area = rect().adjusted(60, 86, -30, -20);
+    m_pitch = qMax(4, qMin(area.width() / columnCount(), area.height() / rowCount()));
+    int width = m_pitch * columnCount();
+    int height = m_pitch * rowCount();
+    m_gridRect = QRect(area.left() + qMax(0, (area.width() - width) / 2), area.top(), width, height);
+}
+
+QRect HeatmapWidget::cellRect(int row, int column) const
+{
+    int gap = qMax(1, m_pitch / 6);
+    return QRect(m_gridRect.left() + column * m_pitch, m_gridRect.top() + row * m_pitch,
+                 m_pitch - gap, m_pitch - gap);
+}
+
+int HeatmapWidget::cellAt(const QPoint &pos, QRect *rect) const
+{
+    if (m_pitch <= 0 || !m_gridRect.contains(pos)) return -1;
+
+    // 直接由坐标换算行列，不遍历格子
+    int column = (pos.x() - m_gridRect.left()) / m_pitch;
+    int row = (pos.y() - m_gridRect.top()) / m_pitch;
+    QRect r = cellRect(row, column);
+    if (!r.contains(pos)) return -1;
+
+    int index = cellIndex(row, column);
+    if (index >= m_levels.size() || m_levels[index] < 0) return -1;
+
+    if (rect) *rect = r;
+    return index;
+}
+
+void HeatmapWidget::paintCell(QPainter &painter, int row, int column)
+{
+    int level = m_levels[cellIndex(row, column)];
+    if (level < 0) return;
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(ThemePalette::instance().heatmapLevel(level));
+    qreal radius = qMax(1, m_pitch / 6);
+    painter.drawRoundedRect(cellRect(row, column), radius, radius);
+}
+
+void HeatmapWidget::rebuildCache()
+{
+    qreal dpr = devicePixelRatioF();
+    m_gridCache = QPixmap(m_gridRect.size() * dpr);
+    m_gridCache.setDevicePixelRatio(dpr);
+    m_gridCache.fill(Qt::transparent);
+
+    QPainter painter(&m_gridCache);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(-m_gridRect.topLeft());
+    for (int row = 0; row < rowCount(); ++row) {
+        for (int column = 0; column < columnCount(); ++column) {
+            paintCell(painter, row, column);
+        }
+    }
+    m_cacheValid = true;
+}
+
+void HeatmapWidget::resizeEvent(QResizeEvent *event)
+{
+    updateGridGeometry();
+    m_cacheValid = false;
+    QWidget::resizeEvent(event);
+}
+
+void HeatmapWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    if (m_gridRect.isEmpty()) updateGridGeometry();
+    if (!m_cacheValid || m_gridCache.devicePixelRatio() != devicePixelRatioF()) rebuildCache();
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const ThemePalette &themePalette = ThemePalette::instance();
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(themePalette.chartBackground());
+    painter.drawRoundedRect(rect(), 10, 10);
+
+    painter.setPen(themePalette.chartBorder());
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRoundedRect(rect().adjusted(0, 0, -1, -1), 10, 10);
+
+    painter.setPen(themePalette.chartTitle());
+    QFont font = painter.font();
+    font.setBold(true);
+    font.setPointSize(11);
+    painter.setFont(font);
+    painter.drawText(QRect(0, 10, width(), 30), Qt::AlignCenter, m_title);
+
+    QColor subColor = themePalette.chartTitle();
+    subColor.setAlpha(100);
+    font.setBold(false);
+    font.setPointSize(9);
+    painter.setFont(font);
+    if (!m_subTitle.isEmpty()) {
+        painter.setPen(subColor);
+        painter.drawText(30, 60, m_subTitle);
+    }
+
+    font.setPointSize(8);
+    painter.setFont(font);
+    painter.setPen(themePalette.chartLabel());
+    for (int row = 0; row < rowCount(); ++row) {
+        QRect labelRect(m_gridRect.left() - 40, m_gridRect.top() + row * m_pitch, 34, m_pitch);
+        painter.drawText(labelRect, Qt::AlignRight | Qt::AlignVCenter, kWeekdayNames.at(row));
+    }
+    for (int column = 0; column < m_columnLabels.size(); ++column) {
+        if (m_columnLabels.at(column).isEmpty()) continue;
+        painter.drawText(m_gridRect.left() + column * m_pitch, m_gridRect.top() - 4, m_columnLabels.at(column));
+    }
+
+    painter.drawPixmap(m_gridRect.topLeft(), m_gridCache);
+}
+
+QString HeatmapWidget::cellToolTip(int index) const
+{
+    int value = m_values.value(index);
+    if (m_layout == YearCalendar) {
+        QDate date = m_gridStart.addDays(index);
+        return QString("%1 %2\n完成 %3 项")
+            .arg(date.toString("yyyy-MM-dd"), kWeekdayNames.at(date.dayOfWeek() - 1))
+            .arg(value);
+    }
+
+    int hour = index % 24;
+    return QString("%1 %2:00-%3:00\n完成 %4 项")
+        .arg(kWeekdayNames.at(index / 24))
+        .arg(hour, 2, 10, QChar('0'))
+        .arg(hour + 1, 2, 10, QChar('0'))
+        .arg(value);
+}
+
+bool HeatmapWidget::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        QRect r;
+        int index = cellAt(helpEvent->pos(), &r);
+        if (index < 0) {
+            QToolTip::hideText();
+            event->ignore();
+        } else {
+            QToolTip::showText(helpEvent->globalPos(), cellToolTip(index), this, r);
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
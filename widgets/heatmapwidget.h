@@ -0,0 +1,60 @@
+#ifndef HEATMAPWIDGET_H
+#define HEATMAPWIDGET_H
+
+#include <QWidget>
+#include <QDate>
+#include <QPixmap>
+#include <QVector>
+
+// 完成情况热力图：年度视图为 53 周 × 7 天，时段视图为 7 天 × 24 小时
+// 格子层缓存为位图，数据变化时只重画颜色等级改变的格子
+class HeatmapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Layout { YearCalendar, WeekdayHour };
+    explicit HeatmapWidget(Layout layout, QString title, QWidget *parent = nullptr);
+
+    // values 从 gridStart（周一）起按天排列，lastDate 之后的格子不显示
+    void setYearData(const QDate &gridStart, const QDate &lastDate, const QVector<int> &values);
+    // values 按 星期(周一起) * 24 + 小时 排列
+    void setWeekdayHourData(const QVector<int> &values);
+    void setSubTitle(const QString &subTitle);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    Layout m_layout;
+    QString m_title;
+    QString m_subTitle;
+
+    QVector<int> m_values;
+    QVector<qint8> m_levels;   // -1 表示该格不显示
+    int m_maxValue;
+    QDate m_gridStart;
+    QStringList m_columnLabels;
+
+    QPixmap m_gridCache;
+    bool m_cacheValid;
+    QRect m_gridRect;
+    int m_pitch;
+
+    int rowCount() const;
+    int columnCount() const;
+    int cellIndex(int row, int column) const;
+    int cellAt(const QPoint &pos, QRect *rect = nullptr) const;
+    QRect cellRect(int row, int column) const;
+
+    void applyValues(const QVector<int> &values, const QVector<qint8> &levels);
+    int levelFor(int value, int maxValue) const;
+    void updateGridGeometry();
+    void rebuildCache();
+    void paintCell(QPainter &painter, int row, int column);
+    QString cellToolTip(int index) const;
+};
+
+#endif // HEATMAPWIDGET_H
@@ -1,23 +1,42 @@
 #include "simplechartwidget.h"
-#include "database/database.h"
+#include "utils/themepalette.h"
 #include <QPainter>
 #include <QPainterPath>
 #include <QtMath>
 #include <QDebug>
 #include <QMouseEvent>
+#include <numeric>
 
 SimpleChartWidget::SimpleChartWidget(ChartType type, QString title, QWidget *parent)
-    : QWidget(parent), m_type(type), m_title(title), m_isHovering(false)
+    : QWidget(parent), m_type(type), m_title(title), m_layerValid(false), m_plotMax(0), m_stepX(0), m_hoverIndex(-1)
 {
     setMinimumSize(300, 250);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMouseTracking(true);
+
+    connect(&ThemePalette::instance(), &ThemePalette::paletteChanged, this, &SimpleChartWidget::invalidateLayer);
+}
+
+void SimpleChartWidget::invalidateLayer()
+{
+    m_layerValid = false;
+    update();
 }
 
 void SimpleChartWidget::setCategoryData(const QMap<QString, int> &data)
 {
     m_categoryData = data;
-    update();
+    m_barLabels = data.keys();
+    m_barValues = QVector<int>(data.begin(), data.end());
+    invalidateLayer();
+}
+
+void SimpleChartWidget::setBarData(const QStringList &labels, const QVector<int> &values)
+{
+    m_categoryData.clear();
+    m_barLabels = labels;
+    m_barValues = values;
+    invalidateLayer();
 }
 
 void SimpleChartWidget::setTrendData(const QVector<int> &data, const QStringList &labels, const QStringList &tooltips)
@@ -25,57 +44,111 @@ void SimpleChartWidget::setTrendData(const QVector<int> &data, const QStringList
     m_trendValues = data;
     m_trendLabels = labels;
     m_tooltips = tooltips;
-    update();
+    m_hoverIndex = -1;
+    m_plotMax = 0;
+    invalidateLayer();
 }
 
 void SimpleChartWidget::setSubTitle(const QString &subTitle)
 {
     m_subTitle = subTitle;
-    update();
+    invalidateLayer();
 }
 
 void SimpleChartWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
+    qreal dpr = devicePixelRatioF();
+    if (!m_layerValid || m_staticLayer.devicePixelRatio() != dpr || m_staticLayer.size() != size() * dpr) {
+        rebuildStaticLayer();
+    }
+
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    painter.drawPixmap(0, 0, m_staticLayer);
+
+    if (m_type == LineChart && m_hoverIndex >= 0) {
+        painter.setRenderHint(QPainter::Antialiasing);
+        drawLineHover(painter);
+    }
+}
 
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    bool isLight = (bgMode == "light");
+void SimpleChartWidget::resizeEvent(QResizeEvent *event)
+{
+    m_layerValid = false;
+    QWidget::resizeEvent(event);
+}
 
-    QColor bgColor = isLight ? QColor("#F5F7FA") : QColor("#303030");
+void SimpleChartWidget::rebuildStaticLayer()
+{
+    qreal dpr = devicePixelRatioF();
+    m_staticLayer = QPixmap(size() * dpr);
+    m_staticLayer.setDevicePixelRatio(dpr);
+    m_staticLayer.fill(Qt::transparent);
+    m_layerValid = true;
+
+    QPainter painter(&m_staticLayer);
+    const ThemePalette::ChartTheme &theme = ThemePalette::instance().chartTheme();
+    render(painter, QRectF(rect()), theme);
+
+    // 悬停层需要的折线图几何信息
+    m_plotRect = chartArea(rect());
+    int count = m_trendValues.size();
+    m_plotMax = count > 0 ? trendScaleMax() : 0;
+    m_stepX = count > 1 ? (double)m_plotRect.width() / (count - 1) : 0;
+    m_axisColor = theme.title;
+    m_axisColor.setAlpha(100);
+}
 
-    QColor borderColor = isLight ? QColor("#dcdfe6") : QColor("#555555");
-    QColor textColor = isLight ? QColor("#303133") : QColor("#ffffff");
+QRect SimpleChartWidget::chartArea(const QRect &bounds)
+{
+    return bounds.adjusted(30, 50, -30, -45);
+}
+
+// 字号按 96 dpi 的布局坐标换算，打印机等高分辨率设备上保持与屏幕相同的比例
+static void setChartFont(QPainter &painter, qreal pointSize, bool bold)
+{
+    QFont font = painter.font();
+    int dpi = painter.device() ? painter.device()->logicalDpiY() : 96;
+    font.setPointSizeF(pointSize * 96.0 / qMax(1, dpi));
+    font.setBold(bold);
+    painter.setFont(font);
+}
+
+void SimpleChartWidget::render(QPainter &painter, const QRectF &target, const ThemePalette::ChartTheme &theme) const
+{
+    painter.save();
+    painter.translate(target.topLeft());
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QRect bounds(0, 0, qRound(target.width()), qRound(target.height()));
 
     painter.setPen(Qt::NoPen);
-    painter.setBrush(bgColor);
-    painter.drawRoundedRect(rect(), 10, 10);
+    painter.setBrush(theme.background);
+    painter.drawRoundedRect(bounds, 10, 10);
 
-    painter.setPen(QPen(borderColor, 1));
+    painter.setPen(theme.border);
     painter.setBrush(Qt::NoBrush);
-    painter.drawRoundedRect(rect().adjusted(0, 0, -1, -1), 10, 10);
+    painter.drawRoundedRect(bounds.adjusted(0, 0, -1, -1), 10, 10);
 
-    painter.setPen(textColor);
-    QFont font = painter.font();
-    font.setBold(true);
-    font.setPointSize(11);
-    painter.setFont(font);
-    QRect titleRect(0, 10, width(), 30);
+    painter.setPen(theme.title);
+    setChartFont(painter, 11, true);
+    QRect titleRect(0, 10, bounds.width(), 30);
     painter.drawText(titleRect, Qt::AlignCenter, m_title);
 
-    QRect chartRect = rect().adjusted(30, 50, -30, -45);
+    QRect chartRect = chartArea(bounds);
 
     if (m_type == PieChart) {
-        drawPieChart(painter, chartRect);
+        drawPieChart(painter, chartRect, theme);
     } else if (m_type == BarChart) {
-        drawBarChart(painter, chartRect);
+        drawBarChart(painter, chartRect, theme);
     } else if (m_type == LineChart) {
-        drawLineChart(painter, chartRect);
+        drawLineChart(painter, chartRect, theme);
     }
+
+    painter.restore();
 }
 
-void SimpleChartWidget::drawPieChart(QPainter &painter, const QRect &rect)
+void SimpleChartWidget::drawPieChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const
 {
     if (m_categoryData.isEmpty()) return;
 
@@ -94,7 +167,7 @@ void SimpleChartWidget::drawPieChart(QPainter &painter, const QRect &rect)
         if (it.value() == 0) continue;
 
         int spanAngle = (it.value() * 360 * 16) / total;
-        painter.setBrush(getColor(colorIndex));
+        painter.setBrush(theme.color(colorIndex));
         painter.setPen(Qt::NoPen);
         painter.drawPie(pieRect, startAngle, spanAngle);
 
@@ -105,18 +178,14 @@ void SimpleChartWidget::drawPieChart(QPainter &painter, const QRect &rect)
     int legendX = pieRect.right() + 20;
     int legendY = rect.top() + 20;
     colorIndex = 0;
-    QFont legendFont = painter.font();
-    legendFont.setPointSize(9);
-    legendFont.setBold(false);
-    painter.setFont(legendFont);
+    setChartFont(painter, 9, false);
 
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    QColor legendTextColor = (bgMode == "light") ? QColor("#606266") : QColor("#cccccc");
+    const QColor &legendTextColor = theme.label;
 
     for (auto it = m_categoryData.begin(); it != m_categoryData.end(); ++it) {
         if (it.value() == 0) continue;
 
-        painter.setBrush(getColor(colorIndex));
+        painter.setBrush(theme.color(colorIndex));
         painter.setPen(Qt::NoPen);
         painter.drawRect(legendX, legendY, 12, 12);
 
@@ -129,77 +198,117 @@ void SimpleChartWidget::drawPieChart(QPainter &painter, const QRect &rect)
     }
 }
 
-void SimpleChartWidget::drawBarChart(QPainter &painter, const QRect &rect)
+void SimpleChartWidget::drawBarChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const
 {
-    if (m_categoryData.isEmpty()) return;
+    QColor subColor = theme.title;
+    subColor.setAlpha(100);
+    drawSubTitle(painter, rect, subColor);
+
+    if (m_barValues.isEmpty()) return;
 
     int maxVal = 0;
-    for (int val : m_categoryData) if (val > maxVal) maxVal = val;
+    for (int val : m_barValues) if (val > maxVal) maxVal = val;
     if (maxVal == 0) maxVal = 1;
 
-    int count = m_categoryData.size();
+    int count = m_barValues.size();
     int barWidth = (rect.width() / count) * 0.6;
     int spacing = (rect.width() / count) * 0.4;
 
     int x = rect.left() + spacing / 2;
     int colorIndex = 0;
 
-    QFont labelFont = painter.font();
-    labelFont.setPointSize(9);
-    labelFont.setBold(false);
-    painter.setFont(labelFont);
+    setChartFont(painter, 9, false);
 
-    QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-    QColor labelColor = (bgMode == "light") ? QColor("#606266") : QColor("#cccccc");
+    const QColor &labelColor = theme.label;
 
-    for (auto it = m_categoryData.begin(); it != m_categoryData.end(); ++it) {
-        int barHeight = (int)((double)it.value() / maxVal * (rect.height() - 20));
+    for (int i = 0; i < count; ++i) {
+        int value = m_barValues[i];
+        int barHeight = (int)((double)value / maxVal * (rect.height() - 20));
 
         QRect barRect(x, rect.bottom() - barHeight, barWidth, barHeight);
 
-        painter.setBrush(getColor(colorIndex));
+        painter.setBrush(theme.color(colorIndex));
         painter.setPen(Qt::NoPen);
         painter.drawRect(barRect);
 
         painter.setPen(labelColor);
         if (barHeight > 20) {
             painter.setPen(Qt::white);
-            painter.drawText(barRect.adjusted(0, 0, 0, 0), Qt::AlignCenter, QString::number(it.value()));
+            painter.drawText(barRect.adjusted(0, 0, 0, 0), Qt::AlignCenter, QString::number(value));
         } else {
             painter.setPen(labelColor);
-            painter.drawText(barRect.adjusted(0, -20, 0, 0), Qt::AlignCenter | Qt::AlignBottom, QString::number(it.value()));
+            painter.drawText(barRect.adjusted(0, -20, 0, 0), Qt::AlignCenter | Qt::AlignBottom, QString::number(value));
         }
 
         painter.setPen(labelColor);
         QRect labelRect(x - 5, rect.bottom() + 10, barWidth + 10, 20);
-        painter.drawText(labelRect, Qt::AlignCenter, it.key());
+        painter.drawText(labelRect, Qt::AlignCenter, m_barLabels.value(i));
 
         x += barWidth + spacing;
         colorIndex++;
     }
 }
 
-void SimpleChartWidget::drawLineChart(QPainter &painter, const QRect &rect)
+// Largest-Triangle-Three-Buckets 降采样：保留首尾点，其余每个桶取与前一选中点、
+// 下一桶均值构成三角形面积最大的点，返回选中点的原始下标（递增）
+static QVector<int> lttbIndices(const QVector<int> &values, int threshold)
 {
-    QColor axisColor = painter.pen().color();
-    axisColor.setAlpha(100);
+    int n = values.size();
+    QVector<int> result;
+    if (threshold >= n || threshold < 3) {
+        result.resize(n);
+        std::iota(result.begin(), result.end(), 0);
+        return result;
+    }
 
-    if (!m_subTitle.isEmpty()) {
-        painter.setPen(axisColor);
-        QFont subFont = painter.font();
-        subFont.setPointSize(9);
-        subFont.setBold(false);
-        painter.setFont(subFont);
-        painter.drawText(rect.left(), rect.top() - 15, m_subTitle);
+    result.reserve(threshold);
+    result.append(0);
+
+    double every = (double)(n - 2) / (threshold - 2);
+    int a = 0;
+
+    for (int i = 0; i < threshold - 2; ++i) {
+        int avgStart = (int)qFloor((i + 1) * every) + 1;
+        int avgEnd = qMin((int)qFloor((i + 2) * every) + 1, n);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (int j = avgStart; j < avgEnd; ++j) {
+            avgX += j;
+            avgY += values[j];
+        }
+        avgX /= (avgEnd - avgStart);
+        avgY /= (avgEnd - avgStart);
+
+        int rangeStart = (int)qFloor(i * every) + 1;
+        int rangeEnd = (int)qFloor((i + 1) * every) + 1;
+        double maxArea = -1.0;
+        int next = rangeStart;
+        for (int j = rangeStart; j < rangeEnd; ++j) {
+            double area = std::abs((a - avgX) * (values[j] - values[a]) - (a - j) * (avgY - values[a]));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+
+        result.append(next);
+        a = next;
     }
 
-    if (m_trendValues.isEmpty()) return;
+    result.append(n - 1);
+    return result;
+}
 
-    m_currentPoints.clear();
+void SimpleChartWidget::drawLineChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const
+{
+    QColor axisColor = theme.title;
+    axisColor.setAlpha(100);
 
-    int maxVal = 0;
-    for (int val : m_trendValues) if (val > maxVal) maxVal = val;
-    maxVal = maxVal < 5 ? 5 : maxVal + 1;
+    drawSubTitle(painter, rect, axisColor);
+
+    if (m_trendValues.isEmpty()) return;
+
+    int maxVal = trendScaleMax();
 
     painter.setPen(axisColor);
     painter.drawLine(rect.bottomLeft(), rect.bottomRight());
@@ -209,116 +318,134 @@ void SimpleChartWidget::drawLineChart(QPainter &painter, const QRect &rect)
     double stepX = count > 1 ? (double)rect.width() / (count - 1) : 0;
     bool showXLabels = (count <= 31);
 
+    if (showXLabels) {
+        setChartFont(painter, 8, false);
+        painter.setPen(axisColor);
+
+        for (int i = 0; i < count && i < m_trendLabels.size(); ++i) {
+            if (count > 15 && (i % 2 != 0)) continue;
+            double x = rect.left() + i * stepX;
+            painter.drawText(x - 20, rect.bottom() + 5, 40, 20, Qt::AlignCenter, m_trendLabels.at(i));
+        }
+    }
+
+    // 点数超过像素宽度时先降采样，折线形状基本不变；悬停提示仍取原始数据
+    QVector<int> indices = lttbIndices(m_trendValues, qMax(3, rect.width()));
     QVector<QPointF> points;
-    for (int i = 0; i < count; ++i) {
+    points.reserve(indices.size());
+    for (int i : indices) {
         double x = rect.left() + i * stepX;
         double y = rect.bottom() - ((double)m_trendValues[i] / maxVal * rect.height());
-        QPointF pt(x, y);
-        points.append(pt);
-        m_currentPoints.append(pt);
-
-        if (showXLabels && i < m_trendLabels.size()) {
-            painter.setPen(axisColor);
-            QFont f = painter.font();
-            f.setPointSize(8);
-            painter.setFont(f);
-
-            if (count > 15 && (i % 2 != 0)) {
-            } else {
-                painter.drawText(x - 20, rect.bottom() + 5, 40, 20, Qt::AlignCenter, m_trendLabels.at(i));
-            }
-        }
+        points.append(QPointF(x, y));
     }
 
     painter.setRenderHint(QPainter::Antialiasing);
-    painter.setPen(QPen(getColor(6), 2));
+    const QColor &lineColor = theme.color(6);
+    painter.setPen(QPen(lineColor, 2));
     if (points.size() > 1) painter.drawPolyline(points.data(), points.size());
 
-    int closestIndex = -1;
-    double minDist = 10000.0;
+    // 点过密时圆点会糊成一片，只画折线
+    if (points.size() > 1 && rect.width() / (points.size() - 1) < 6) return;
 
-    if (m_isHovering) {
-        for (int i = 0; i < m_currentPoints.size(); ++i) {
-            double dist = std::abs(m_currentPoints[i].x() - m_mousePos.x());
-            if (dist < minDist && dist < stepX / 2 + 5) {
-                minDist = dist;
-                closestIndex = i;
-            }
+    const QBrush &pointFill = theme.pointFill;
+
+    for (int j = 0; j < points.size(); ++j) {
+        painter.setBrush(pointFill);
+        painter.setPen(QPen(lineColor, 2));
+        painter.drawEllipse(points[j], 3, 3);
+
+        int value = m_trendValues[indices[j]];
+        if (count <= 15 && value > 0) {
+            painter.setPen(axisColor);
+            painter.drawText(points[j].x() - 15, points[j].y() - 20, 30, 15, Qt::AlignCenter, QString::number(value));
         }
     }
+}
 
-    for (int j = 0; j < points.size(); ++j) {
-        QString bgMode = Database::instance().getSetting("bg_mode", "dark");
-        painter.setBrush(bgMode == "light" ? Qt::white : QColor("#2d2d2d"));
-
-        if (j == closestIndex) {
-            painter.setPen(QPen(axisColor, 2));
-            painter.drawEllipse(points[j], 5, 5);
-
-            QString tipText = QString("数值: %1").arg(m_trendValues[j]);
-            if (j < m_tooltips.size()) {
-                tipText = QString("%1\n%2").arg(m_tooltips[j]).arg(tipText);
-            } else if (j < m_trendLabels.size()) {
-                tipText = QString("%1\n%2").arg(m_trendLabels[j]).arg(tipText);
-            }
+void SimpleChartWidget::drawLineHover(QPainter &painter)
+{
+    int j = m_hoverIndex;
+    if (j >= m_trendValues.size() || m_plotMax <= 0) return;
+    QPointF point(m_plotRect.left() + j * m_stepX,
+                  m_plotRect.bottom() - ((double)m_trendValues[j] / m_plotMax * m_plotRect.height()));
+
+    painter.setBrush(ThemePalette::instance().chartPointFill());
+    painter.setPen(QPen(m_axisColor, 2));
+    painter.drawEllipse(point, 5, 5);
+
+    QString tipText = QString("数值: %1").arg(m_trendValues[j]);
+    if (j < m_tooltips.size()) {
+        tipText = QString("%1\n%2").arg(m_tooltips[j]).arg(tipText);
+    } else if (j < m_trendLabels.size()) {
+        tipText = QString("%1\n%2").arg(m_trendLabels[j]).arg(tipText);
+    }
 
-            QFont tipFont = painter.font();
-            tipFont.setPointSize(9);
-            QFontMetrics fm(tipFont);
-            QRect tipRect = fm.boundingRect(QRect(0,0,0,0), Qt::AlignLeft, tipText);
-            tipRect.adjust(-5, -5, 5, 5);
-            tipRect.moveCenter(points[j].toPoint() + QPoint(0, -35));
+    QFont tipFont = painter.font();
+    tipFont.setPointSize(9);
+    QFontMetrics fm(tipFont);
+    QRect tipRect = fm.boundingRect(QRect(0,0,0,0), Qt::AlignLeft, tipText);
+    tipRect.adjust(-5, -5, 5, 5);
+    tipRect.moveCenter(point.toPoint() + QPoint(0, -35));
 
-            if (tipRect.left() < 0) tipRect.moveLeft(5);
-            if (tipRect.right() > width()) tipRect.moveRight(width() - 5);
+    if (tipRect.left() < 0) tipRect.moveLeft(5);
+    if (tipRect.right() > width()) tipRect.moveRight(width() - 5);
 
-            painter.setBrush(QColor(0, 0, 0, 200));
-            painter.setPen(Qt::NoPen);
-            painter.drawRoundedRect(tipRect, 4, 4);
+    painter.setBrush(QColor(0, 0, 0, 200));
+    painter.setPen(Qt::NoPen);
+    painter.drawRoundedRect(tipRect, 4, 4);
 
-            painter.setPen(Qt::white);
-            painter.setFont(tipFont);
-            painter.drawText(tipRect, Qt::AlignCenter, tipText);
+    painter.setPen(Qt::white);
+    painter.setFont(tipFont);
+    painter.drawText(tipRect, Qt::AlignCenter, tipText);
+}
 
-        } else {
-            painter.setPen(QPen(getColor(6), 2));
-            painter.drawEllipse(points[j], 3, 3);
+int SimpleChartWidget::hoverIndexAt(const QPoint &pos) const
+{
+    int count = m_trendValues.size();
+    if (count == 0 || m_plotMax <= 0) return -1;
 
-            if (count <= 15 && m_trendValues[j] > 0) {
-                painter.setPen(axisColor);
-                painter.drawText(points[j].x() - 15, points[j].y() - 20, 30, 15, Qt::AlignCenter, QString::number(m_trendValues[j]));
-            }
-        }
+    // 横坐标与原始下标一一对应且等距，相当于按像素分桶的索引，O(1) 定位最近的原始点
+    int index = 0;
+    if (count > 1 && m_stepX > 0) {
+        index = qBound(0, qRound((pos.x() - m_plotRect.left()) / m_stepX), count - 1);
     }
+    double dist = std::abs(m_plotRect.left() + index * m_stepX - pos.x());
+    return dist < m_stepX / 2 + 5 ? index : -1;
+}
+
+void SimpleChartWidget::drawSubTitle(QPainter &painter, const QRect &rect, const QColor &color) const
+{
+    if (m_subTitle.isEmpty()) return;
+
+    painter.setPen(color);
+    setChartFont(painter, 9, false);
+    painter.drawText(rect.left(), rect.top() - 15, m_subTitle);
 }
 
-QColor SimpleChartWidget::getColor(int index) const
+int SimpleChartWidget::trendScaleMax() const
 {
-    static const QStringList palette = {
-        "#7696B3", // 钢蓝
-        "#D69E68", // 大地橙
-        "#7FA882", // 鼠尾草绿
-        "#C96A6A", // 柔和砖红
-        "#B48EAD", // 莫兰迪紫
-        "#8C949E", // 冷灰
-        "#88C0D0", // 北欧蓝
-        "#EBCB8B", // 麦穗黄
-        "#BF616A"  // 浆果红
-    };
-    return QColor(palette[index % palette.size()]);
+    int maxVal = 0;
+    for (int val : m_trendValues) if (val > maxVal) maxVal = val;
+    return maxVal < 5 ? 5 : maxVal + 1;
 }
 
 void SimpleChartWidget::mouseMoveEvent(QMouseEvent *event)
 {
-    m_mousePos = event->pos();
-    m_isHovering = true;
-    update();
+    if (m_type == LineChart) {
+        int index = hoverIndexAt(event->pos());
+        if (index != m_hoverIndex) {
+            m_hoverIndex = index;
+            update();
+        }
+    }
     QWidget::mouseMoveEvent(event);
 }
 
 void SimpleChartWidget::leaveEvent(QEvent *event)
 {
-    m_isHovering = false;
-    update();
+    if (m_hoverIndex >= 0) {
+        m_hoverIndex = -1;
+        update();
+    }
     QWidget::leaveEvent(event);
 }
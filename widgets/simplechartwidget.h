@@ -4,6 +4,8 @@
 #include <QWidget>
 #include <QMap>
 #include <QDate>
+#include <QPixmap>
+#include "utils/themepalette.h"
 
 class SimpleChartWidget : public QWidget
 {
@@ -14,11 +16,18 @@ public:
     explicit SimpleChartWidget(ChartType type, QString title, QWidget *parent = nullptr);
 
     void setCategoryData(const QMap<QString, int> &data);
+    // 柱状图按给定顺序绘制（例如直方图区间）
+    void setBarData(const QStringList &labels, const QVector<int> &values);
     void setTrendData(const QVector<int> &data, const QStringList &labels, const QStringList &tooltips = QStringList());
     void setSubTitle(const QString &subTitle);
 
+    // 按给定配色把整张图表画到 target 区域，屏幕缓存和导出报表共用
+    using QWidget::render;
+    void render(QPainter &painter, const QRectF &target, const ThemePalette::ChartTheme &theme) const;
+
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void leaveEvent(QEvent *event) override;
 
@@ -27,19 +36,33 @@ private:
     QString m_title;
     QString m_subTitle;
     QMap<QString, int> m_categoryData;
+    QStringList m_barLabels;
+    QVector<int> m_barValues;
     QVector<int> m_trendValues;
     QStringList m_trendLabels;
     QStringList m_tooltips;
 
-    QVector<QPointF> m_currentPoints;
-    QPoint m_mousePos;
-    bool m_isHovering;
+    // 静态图层（背景、标题、图形）缓存为位图，悬停时只在其上叠加高亮和提示
+    QPixmap m_staticLayer;
+    bool m_layerValid;
 
-    void drawPieChart(QPainter &painter, const QRect &rect);
-    void drawBarChart(QPainter &painter, const QRect &rect);
-    void drawLineChart(QPainter &painter, const QRect &rect);
+    // 折线图的绘制区域和纵轴上限，悬停时据此由原始下标换算坐标
+    QRect m_plotRect;
+    int m_plotMax;
+    double m_stepX;
+    QColor m_axisColor;
+    int m_hoverIndex;
 
-    QColor getColor(int index) const;
+    static QRect chartArea(const QRect &bounds);
+    void drawPieChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const;
+    void drawBarChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const;
+    void drawLineChart(QPainter &painter, const QRect &rect, const ThemePalette::ChartTheme &theme) const;
+    void drawSubTitle(QPainter &painter, const QRect &rect, const QColor &color) const;
+    int trendScaleMax() const;
+    void drawLineHover(QPainter &painter);
+    void rebuildStaticLayer();
+    void invalidateLayer();
+    int hoverIndexAt(const QPoint &pos) const;
 };
 
 #endif // SIMPLECHARTWIDGET_H
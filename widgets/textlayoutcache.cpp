@@ -0,0 +1,69 @@
+#include "textlayoutcache.h"
+#include <QFontMetrics>
+#include <QTextOption>
+#include <QTransform>
+#include <QHash>
+
+TextLayoutCache::TextLayoutCache(int maxEntries)
+    : m_cache(maxEntries)
+{
+}
+
+const QStaticText &TextLayoutCache::plain(int id, int slot, const QString &text, const QFont &font)
+{
+    return lookup(id, slot, text, -1, font, Plain);
+}
+
+const QStaticText &TextLayoutCache::elided(int id, int slot, const QString &text, int width, const QFont &font)
+{
+    return lookup(id, slot, text, width, font, Elided);
+}
+
+const QStaticText &TextLayoutCache::wrapped(int id, int slot, const QString &text, int width, const QFont &font)
+{
+    return lookup(id, slot, text, width, font, Wrapped);
+}
+
+void TextLayoutCache::clear()
+{
+    m_cache.clear();
+}
+
+const QStaticText &TextLayoutCache::lookup(int id, int slot, const QString &text, int width,
+                                           const QFont &font, Mode mode)
+{
+    quint64 key = (quint64(quint32(id)) << 8) | quint64(slot & 0xff);
+    size_t textHash = qHash(text);
+    QString fontKey = font.key();
+
+    Entry *entry = m_cache.object(key);
+    if (entry && entry->textHash == textHash && entry->width == width
+        && entry->mode == mode && entry->fontKey == fontKey) {
+        return entry->text;
+    }
+
+    entry = new Entry;
+    entry->textHash = textHash;
+    entry->width = width;
+    entry->mode = mode;
+    entry->fontKey = fontKey;
+    entry->text.setTextFormat(Qt::PlainText);
+    entry->text.setPerformanceHint(QStaticText::AggressiveCaching);
+
+    if (mode == Elided) {
+        QFontMetrics fm(font);
+        entry->text.setText(fm.elidedText(text, Qt::ElideRight, width));
+    } else if (mode == Wrapped) {
+        QTextOption option;
+        option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+        entry->text.setTextOption(option);
+        entry->text.setTextWidth(width);
+        entry->text.setText(text);
+    } else {
+        entry->text.setText(text);
+    }
+    entry->text.prepare(QTransform(), font);
+
+    m_cache.insert(key, entry);
+    return m_cache.object(key)->text;
+}
@@ -0,0 +1,38 @@
+#ifndef TEXTLAYOUTCACHE_H
+#define TEXTLAYOUTCACHE_H
+
+#include <QCache>
+#include <QFont>
+#include <QStaticText>
+#include <QString>
+
+// 委托绘制用的文本排版缓存，按 (条目id, 槽位) 存放已排版的 QStaticText。
+// 文本、宽度或字体变化时条目会被重新排版替换，因此数据变更后自然失效。
+class TextLayoutCache
+{
+public:
+    explicit TextLayoutCache(int maxEntries = 4000);
+
+    const QStaticText &plain(int id, int slot, const QString &text, const QFont &font);
+    const QStaticText &elided(int id, int slot, const QString &text, int width, const QFont &font);
+    const QStaticText &wrapped(int id, int slot, const QString &text, int width, const QFont &font);
+
+    void clear();
+
+private:
+    enum Mode { Plain, Elided, Wrapped };
+
+    struct Entry {
+        size_t textHash;
+        int width;
+        int mode;
+        QString fontKey;
+        QStaticText text;
+    };
+
+    QCache<quint64, Entry> m_cache;
+
+    const QStaticText &lookup(int id, int slot, const QString &text, int width, const QFont &font, Mode mode);
+};
+
+#endif // TEXTLAYOUTCACHE_H